@@ -108,7 +108,12 @@ private:
 
                 std::vector<std::string> res;
                 str_split(cmd, res, " "); // 拆解语句
-                sql_execute(res, cmd);       // 语句执行
+                try {
+                    sql_execute(res, cmd);   // 语句执行
+                } catch (bpT::ioError &e) {
+                    // 页读取失败，语句中止
+                    std::cout << e.what() << std::endl;
+                }
             } else {
                 // 无法解析
                 std::cout << "Syntax error!" << std::endl;
@@ -154,8 +159,9 @@ private:
                 // create table
                 std::string create_table_xxx = "create\\stable\\s[a-zA-Z]+[a-zA-Z0-9]*";
                 std::string name_type_constraint = "[a-zA-Z]+[a-zA-Z0-9]*\\s(int|string)\\s?(\\sprimary)?";
+                std::string storage_option = "(with\\s?\\(\\s?storage\\s?=\\s?(row|column)\\s?\\)\\s?)?";
                 std::string create_table_regex = "^\\s?" + create_table_xxx + "\\s?\\(\\s?(" +
-                                                 name_type_constraint + "\\s?,\\s?" + ")*(" + name_type_constraint + "\\s?,?\\s?)" + "\\)\\s?" + "$";
+                                                 name_type_constraint + "\\s?,\\s?" + ")*(" + name_type_constraint + "\\s?,?\\s?)" + "\\)\\s?" + storage_option + "(using\\shash)?$";
                 // 正则表达式匹配
                 if (std::regex_match(cmd.c_str(), std::regex(create_table_regex))) {
                     // 获取表名
@@ -174,6 +180,31 @@ private:
                     }
                     return status;
                 }
+            } else if (res[1] == "index") {
+                // create index xxx on xxx(xxx[, xxx]) [using hash]
+                std::string create_index_xxx = "create\\sindex\\s[a-zA-Z]+[a-zA-Z0-9]*\\son\\s[a-zA-Z]+[a-zA-Z0-9]*";
+                std::string column_list = "[a-zA-Z]+[a-zA-Z0-9]*(\\s?,\\s?[a-zA-Z]+[a-zA-Z0-9]*)*";
+                std::string create_index_regex = "^\\s?" + create_index_xxx + "\\s?\\(\\s?" + column_list + "\\s?\\)\\s?(using\\shash)?$";
+                // 正则表达式匹配
+                if (std::regex_match(cmd, std::regex(create_index_regex))) {
+                    // 获取表名及属性名
+                    std::vector<std::string> target;
+                    bool hashed = cmd.ends_with("using hash");
+                    str_split(cmd.substr(cmd.find(" on ") + 4, cmd.rfind(")") - cmd.find(" on ") - 4), target, " (),");
+                    // 表存在判定
+                    if (searchTable(name, target[0])) {
+                        // 创建索引
+                        if (DDL::createIndex(name, res[2], target[0], {target.begin() + 1, target.end()}, hashed, indexCache,
+                                             times)) {
+                            std::cout << std::format("Create index successfully in {}!\n", times.get_duration());
+                        } else {
+                            status &= false;
+                        }
+                    } else {
+                        status &= false;
+                    }
+                    return status;
+                }
             }
         }
         // insert xxx xxx
@@ -196,6 +227,28 @@ private:
                 return status;
             }
         }
+        // load xxx from "xxx"
+        else if (res[0] == "load") {
+            std::string load_xxx = "load\\s[a-zA-Z]+[a-zA-Z0-9]*\\sfrom\\s\".+\"";
+            std::string load_regex = "^\\s?" + load_xxx + "\\s?" + "$";
+            // 正则表达式匹配
+            if (std::regex_match(cmd, std::regex(load_regex))) {
+                // 表存在判定
+                if (searchTable(name, res[1])) {
+                    // 获取文件路径
+                    std::string filename = cmd.substr(cmd.find("\"") + 1, cmd.rfind("\"") - cmd.find("\"") - 1);
+                    // 批量导入
+                    if (DML::loadRecords(name, res[1], filename, indexCache, times)) {
+                        std::cout << std::format("Load table successfully in {}!\n", times.get_duration());
+                    } else {
+                        status &= false;
+                    }
+                } else {
+                    status &= false;
+                }
+                return status;
+            }
+        }
         // use xxx
         else if (res[0] == "use") {
             // use xxx
@@ -270,9 +323,13 @@ private:
                 }
                 // 表存在判定
                 if (searchTable(name, res[1])) {
-                    // 删除表记录
+                    // 删除表记录，并报告本语句写回的字节数及合并写回节省的系统调用次数
+                    auto bytes = bpT::pool().bytesWritten();
+                    auto saved = bpT::pool().syscallsSaved();
                     if (DML::deleteRecord(name, res[1], cmd, indexCache, times)) {
-                        std::cout << std::format("Delete record successfully in {}!\n", times.get_duration());
+                        std::cout << std::format("Delete record successfully in {} ({} bytes written, {} syscalls saved)!\n",
+                                                 times.get_duration(), bpT::pool().bytesWritten() - bytes,
+                                                 bpT::pool().syscallsSaved() - saved);
                     } else {
                         status &= false;
                     }
@@ -305,9 +362,33 @@ private:
                 }
                 // 表存在判定
                 if (searchTable(name, res[1])) {
-                    // 更新表记录
+                    // 更新表记录，并报告本语句写回的字节数及合并写回节省的系统调用次数
+                    auto bytes = bpT::pool().bytesWritten();
+                    auto saved = bpT::pool().syscallsSaved();
                     if (DML::updateRecord(name, res[1], cmd, indexCache, times)) {
-                        std::cout << std::format("Update record successfully in {}!\n", times.get_duration());
+                        std::cout << std::format("Update record successfully in {} ({} bytes written, {} syscalls saved)!\n",
+                                                 times.get_duration(), bpT::pool().bytesWritten() - bytes,
+                                                 bpT::pool().syscallsSaved() - saved);
+                    } else {
+                        status &= false;
+                    }
+                } else {
+                    status &= false;
+                }
+                return status;
+            }
+        }
+        // vacuum xxx [auto|manual]
+        else if (res[0] == "vacuum") {
+            std::string vacuum_xxx = "vacuum\\s[a-zA-Z]+[a-zA-Z0-9]*(\\s(auto|manual))?";
+            std::string vacuum_regex = "^\\s?" + vacuum_xxx + "\\s?" + "$";
+            // 正则表达式匹配
+            if (std::regex_match(cmd, std::regex(vacuum_regex))) {
+                // 表存在判定
+                if (searchTable(name, res[1])) {
+                    // 整理表
+                    if (DDL::vacuumTable(name, res[1], res.size() > 2 ? res[2] : "", indexCache, times)) {
+                        std::cout << std::format("Vacuum table successfully in {}!\n", times.get_duration());
                     } else {
                         status &= false;
                     }
@@ -317,6 +398,43 @@ private:
                 return status;
             }
         }
+        // set pool xxx / set readahead xxx
+        else if (res[0] == "set") {
+            std::string set_pool_regex = "^\\s?set\\spool\\s\\d{1,7}\\s?$";
+            // 正则表达式匹配
+            if (std::regex_match(cmd, std::regex(set_pool_regex))) {
+                // 调整缓冲池预算，单位MB
+                if (DDL::setPool(res[2], times)) {
+                    std::cout << std::format("Set pool successfully in {}!\n", times.get_duration());
+                } else {
+                    status &= false;
+                }
+                return status;
+            }
+            std::string set_readahead_regex = "^\\s?set\\sreadahead\\s\\d{1,4}\\s?$";
+            if (std::regex_match(cmd, std::regex(set_readahead_regex))) {
+                // 调整顺序扫描的预读窗口，单位页
+                if (DDL::setReadahead(res[2], times)) {
+                    std::cout << std::format("Set readahead successfully in {}!\n", times.get_duration());
+                } else {
+                    status &= false;
+                }
+                return status;
+            }
+        }
+        // show pool
+        else if (res[0] == "show") {
+            std::string show_pool_regex = "^\\s?show\\spool\\s?$";
+            // 正则表达式匹配
+            if (std::regex_match(cmd, std::regex(show_pool_regex))) {
+                if (DQL::showPool(times)) {
+                    std::cout << std::format("Show pool successfully in {}!\n", times.get_duration());
+                } else {
+                    status &= false;
+                }
+                return status;
+            }
+        }
         // drop xxx xxx
         else if (res[0] == "drop") {
             // drop database xxx
@@ -370,6 +488,9 @@ private:
     }
     /*退出时清理*/
     void clear() {
+        if (!bpT::pool().flushAll()) {
+            std::cout << "Some pages were not written back!" << std::endl;
+        }
         std::cout << "Bye" << std::endl;
     }
 };
\ No newline at end of file
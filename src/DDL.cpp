@@ -21,6 +21,8 @@ bool DDL::createDatabase(const std::string &database, CPUTimer &times) {
 
 bool DDL::dropDatabase(const std::string &database, CPUTimer &times) {
     std::string dbPath = "data/" + database;
+    bpT::pool().discardDir(dbPath + "/");
+    schemas().drop(database);
     try {
         if (!std::filesystem::remove(dbPath)) {
             std::cout << "Failed to drop database!" << std::endl;
@@ -56,7 +58,7 @@ bool DDL::createTable(const std::string &database, const std::string &tablename,
     std::vector<tColumn> data;
     std::string content = cmd.substr(cmd.find("(") + 1, cmd.find(")") - cmd.find("(") - 1);
     std::vector<tColumn> primaryKey;
-    int pkPos = 0;
+    std::vector<int> pkPos;
     str_process(content);
     str_split(content, split_res, std::regex("\\s?,\\s?"));
 
@@ -78,23 +80,23 @@ bool DDL::createTable(const std::string &database, const std::string &tablename,
         data.push_back(d);
         if (d.is_primary) {
             primaryKey.push_back(d);
-            pkPos = i;
+            pkPos.push_back(i);
         }
     }
 
-    if (primaryKey.size() > 1) {
-        std::cout << "syntax error!" << std::endl;
-        return false;
-    }
     if (primaryKey.size() == 0 && data.size() > 0) {
         primaryKey.push_back(data.front());
-        pkPos = 0;
+        pkPos.push_back(0);
     }
     tPropTypeList_t tProps;
     for (auto i : data) {
         tProps.push_back({i.name, 1 - (char)i.type});
     }
-    if (primaryKey.front().type == 0) { // int
+    // with (storage = column)
+    bool columnar = std::regex_search(cmd, std::regex("\\swith\\s?\\(\\s?storage\\s?=\\s?column\\s?\\)"));
+    // using hash
+    bool hashed = std::regex_search(cmd, std::regex("\\)\\s?(with\\s?\\(.*\\)\\s?)?using\\shash$"));
+    if (primaryKey.size() == 1 && primaryKey.front().type == 0) { // int
         int tableID = -1;
         for (auto i = 0; i < (int)indexCache.iCaches.size(); ++i) {
             if (indexCache.iCaches[i].database == database && indexCache.iCaches[i].name == tablename) {
@@ -116,10 +118,10 @@ bool DDL::createTable(const std::string &database, const std::string &tablename,
         table<int> &t = indexCache.iCaches[tableID];
         t.renew();
         t.init(database, tablename);
-        auto res = t.createTable(tProps, pkPos);
+        auto res = t.createTable(tProps, pkPos, columnar, hashed);
         times.end();
         return res;
-    } else { // string
+    } else { // string，组合主键以各属性的保序编码为string主键
         int tableID = -1;
         for (auto i = 0; i < (int)indexCache.sCaches.size(); ++i) {
             if (indexCache.sCaches[i].database == database && indexCache.sCaches[i].name == tablename) {
@@ -141,7 +143,7 @@ bool DDL::createTable(const std::string &database, const std::string &tablename,
         table<std::string> &t = indexCache.sCaches[tableID];
         t.renew();
         t.init(database, tablename);
-        auto res = t.createTable(tProps, pkPos);
+        auto res = t.createTable(tProps, pkPos, columnar, hashed);
         times.end();
         return res;
     }
@@ -151,4 +153,140 @@ bool DDL::dropTable(const std::string &database, const std::string &tablename, C
     auto res = table<>::dropTable(database, tablename);
     times.end();
     return res;
-}
\ No newline at end of file
+}
+
+bool DDL::vacuumTable(const std::string &database, const std::string &tablename, const std::string &mode,
+                      cache<table> &indexCache, CPUTimer &times) {
+    if (table<>::getKeyType(database, tablename) == 0) { // int
+        int tableID = -1;
+        for (auto i = 0; i < (int)indexCache.iCaches.size(); ++i) {
+            if (indexCache.iCaches[i].database == database && indexCache.iCaches[i].name == tablename) {
+                if (indexCache.last == i) {
+                    indexCache.last = 3 - indexCache.last - indexCache.first;
+                    indexCache.first = i;
+                } else {
+                    indexCache.first = i;
+                }
+                tableID = i;
+                break;
+            }
+        }
+        if (tableID == -1) {
+            tableID = indexCache.last;
+            indexCache.iCaches[tableID].renew();
+            indexCache.iCaches[tableID].init(database, tablename);
+            indexCache.iCaches[tableID].openTable();
+            indexCache.last = 3 - indexCache.first - indexCache.last;
+            indexCache.first = tableID;
+        }
+        table<int> &t = indexCache.iCaches[tableID];
+        if (mode != "") {
+            t.setAutoVacuum(mode == "auto");
+        }
+        auto res = t.vacuumTable();
+        times.end();
+        return res;
+    } else { // string
+        int tableID = -1;
+        for (auto i = 0; i < (int)indexCache.sCaches.size(); ++i) {
+            if (indexCache.sCaches[i].database == database && indexCache.sCaches[i].name == tablename) {
+                if (indexCache.last == i) {
+                    indexCache.last = 3 - indexCache.last - indexCache.first;
+                    indexCache.first = i;
+                } else {
+                    indexCache.first = i;
+                }
+                tableID = i;
+                break;
+            }
+        }
+        if (tableID == -1) {
+            tableID = indexCache.last;
+            indexCache.sCaches[tableID].renew();
+            indexCache.sCaches[tableID].init(database, tablename);
+            indexCache.sCaches[tableID].openTable();
+            indexCache.last = 3 - indexCache.first - indexCache.last;
+            indexCache.first = tableID;
+        }
+        table<std::string> &t = indexCache.sCaches[tableID];
+        if (mode != "") {
+            t.setAutoVacuum(mode == "auto");
+        }
+        auto res = t.vacuumTable();
+        times.end();
+        return res;
+    }
+}
+
+bool DDL::createIndex(const std::string &database, const std::string &indexname, const std::string &tablename,
+                      const std::vector<std::string> &columns, bool hashed, cache<table> &indexCache,
+                      CPUTimer &times) {
+    if (table<>::getKeyType(database, tablename) == 0) { // int
+        int tableID = -1;
+        for (auto i = 0; i < (int)indexCache.iCaches.size(); ++i) {
+            if (indexCache.iCaches[i].database == database && indexCache.iCaches[i].name == tablename) {
+                if (indexCache.last == i) {
+                    indexCache.last = 3 - indexCache.last - indexCache.first;
+                    indexCache.first = i;
+                } else {
+                    indexCache.first = i;
+                }
+                tableID = i;
+                break;
+            }
+        }
+        if (tableID == -1) {
+            tableID = indexCache.last;
+            indexCache.iCaches[tableID].renew();
+            indexCache.iCaches[tableID].init(database, tablename);
+            indexCache.iCaches[tableID].openTable();
+            indexCache.last = 3 - indexCache.first - indexCache.last;
+            indexCache.first = tableID;
+        }
+        table<int> &t = indexCache.iCaches[tableID];
+        auto res = t.createIndex(indexname, columns, hashed);
+        times.end();
+        return res;
+    } else { // string
+        int tableID = -1;
+        for (auto i = 0; i < (int)indexCache.sCaches.size(); ++i) {
+            if (indexCache.sCaches[i].database == database && indexCache.sCaches[i].name == tablename) {
+                if (indexCache.last == i) {
+                    indexCache.last = 3 - indexCache.last - indexCache.first;
+                    indexCache.first = i;
+                } else {
+                    indexCache.first = i;
+                }
+                tableID = i;
+                break;
+            }
+        }
+        if (tableID == -1) {
+            tableID = indexCache.last;
+            indexCache.sCaches[tableID].renew();
+            indexCache.sCaches[tableID].init(database, tablename);
+            indexCache.sCaches[tableID].openTable();
+            indexCache.last = 3 - indexCache.first - indexCache.last;
+            indexCache.first = tableID;
+        }
+        table<std::string> &t = indexCache.sCaches[tableID];
+        auto res = t.createIndex(indexname, columns, hashed);
+        times.end();
+        return res;
+    }
+}
+bool DDL::setPool(const std::string &megabytes, CPUTimer &times) {
+    size_t mb = std::stoull(megabytes);
+    if (mb == 0) {
+        std::cout << "Pool size must be at least 1MB!" << std::endl;
+        return false;
+    }
+    bpT::pool().resize(mb * 1024 * 1024);
+    times.end();
+    return true;
+}
+bool DDL::setReadahead(const std::string &pages, CPUTimer &times) {
+    bpT::readaheadWindow() = std::stoi(pages);
+    times.end();
+    return true;
+}
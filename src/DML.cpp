@@ -9,20 +9,23 @@
 
 #include "SQL.h"
 
-bool DML::insertRecord(const std::string &database, const std::string &tablename, const std::string &cmd,
-                       cache<table> &indexCache, CPUTimer &times) {
+/**
+ * @brief   解析values中的常量列表
+ * @param   content 括号内的常量列表，解析前先做预处理
+ * @param   data    输出，各常量
+ */
+static void parseValues(std::string &content, std::vector<tRow> &data) {
+    static const std::regex sep("\\s?,\\s?"), intValue("-?\\d+"), strValue("\".+\"");
     std::vector<std::string> split_res;
-    std::vector<tRow> data;
-    std::string content = cmd.substr(cmd.find("(") + 1, cmd.find(")") - cmd.find("(") - 1);
     str_process(content);
-    str_split(content, split_res, std::regex("\\s?,\\s?"));
+    str_split(content, split_res, sep);
 
     for (auto i : split_res) {
         if (i.front() == ' ')
             i.erase(0, 1);
         tRow d;
         std::smatch res;
-        if (std::regex_match(i, res, std::regex("-?\\d+"))) {
+        if (std::regex_match(i, res, intValue)) {
             d.type = INT;
 
             // string -> int
@@ -31,7 +34,7 @@ bool DML::insertRecord(const std::string &database, const std::string &tablename
             ss >> i_value;
 
             d.i_value = i_value;
-        } else if (std::regex_match(i, res, std::regex("\".+\""))) {
+        } else if (std::regex_match(i, res, strValue)) {
             d.type = STRING;
 
             d.s_value = res[0];
@@ -43,6 +46,13 @@ bool DML::insertRecord(const std::string &database, const std::string &tablename
 
         data.push_back(d);
     }
+}
+
+bool DML::insertRecord(const std::string &database, const std::string &tablename, const std::string &cmd,
+                       cache<table> &indexCache, CPUTimer &times) {
+    std::vector<tRow> data;
+    std::string content = cmd.substr(cmd.find("(") + 1, cmd.find(")") - cmd.find("(") - 1);
+    parseValues(content, data);
 
     if (table<>::getKeyType(database, tablename) == 0) { // int
         int tableID = -1;
@@ -67,8 +77,14 @@ bool DML::insertRecord(const std::string &database, const std::string &tablename
             indexCache.first = tableID;
         }
         table<int> &t = indexCache.iCaches[tableID];
-        auto pk = t.getPrimaryKey();
-        t.insertTable({data[pk].i_value, content});
+        int key;
+        if (!t.keyOf(data, key)) {
+            std::cout << "Syntax error!" << std::endl;
+            return false;
+        }
+        if (!t.insertTable({key, content})) {
+            return false;
+        }
     } else { // string
         int tableID = -1;
         for (auto i = 0; i < (int)indexCache.sCaches.size(); ++i) {
@@ -92,8 +108,14 @@ bool DML::insertRecord(const std::string &database, const std::string &tablename
             indexCache.first = tableID;
         }
         table<std::string> &t = indexCache.sCaches[tableID];
-        auto pk = t.getPrimaryKey();
-        t.insertTable({data[pk].s_value, content});
+        std::string key;
+        if (!t.keyOf(data, key)) {
+            std::cout << "Syntax error!" << std::endl;
+            return false;
+        }
+        if (!t.insertTable({key, content})) {
+            return false;
+        }
     }
     times.end();
     return true;
@@ -275,4 +297,93 @@ bool DML::deleteRecord(const std::string &database, const std::string &tablename
         times.end();
         return res;
     }
-}
\ No newline at end of file
+}
+bool DML::loadRecords(const std::string &database, const std::string &tablename, const std::string &filename,
+                      cache<table> &indexCache, CPUTimer &times) {
+    std::ifstream fin(filename);
+    if (!fin.is_open()) {
+        std::cout << "File not exists!" << std::endl;
+        return false;
+    }
+    // 每行一条记录，格式同insert的values，括号可省略
+    std::vector<std::string> contents;
+    std::vector<std::vector<tRow>> datas;
+    std::string line;
+    while (std::getline(fin, line)) {
+        auto l = line.find("("), r = line.rfind(")");
+        std::string content = (l != std::string::npos && r != std::string::npos && l < r) ? line.substr(l + 1, r - l - 1)
+                                                                                          : line;
+        if (content.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        datas.emplace_back();
+        parseValues(content, datas.back());
+        contents.push_back(std::move(content));
+    }
+
+    if (table<>::getKeyType(database, tablename) == 0) { // int
+        int tableID = -1;
+        for (auto i = 0; i < (int)indexCache.iCaches.size(); ++i) {
+            if (indexCache.iCaches[i].database == database && indexCache.iCaches[i].name == tablename) {
+                if (indexCache.last == i) {
+                    indexCache.last = 3 - indexCache.last - indexCache.first;
+                    indexCache.first = i;
+                } else {
+                    indexCache.first = i;
+                }
+                tableID = i;
+                break;
+            }
+        }
+        if (tableID == -1) {
+            tableID = indexCache.last;
+            indexCache.iCaches[tableID].renew();
+            indexCache.iCaches[tableID].init(database, tablename);
+            indexCache.iCaches[tableID].openTable();
+            indexCache.last = 3 - indexCache.first - indexCache.last;
+            indexCache.first = tableID;
+        }
+        table<int> &t = indexCache.iCaches[tableID];
+        std::vector<bpT::bpTree<int>::keyValue> vs;
+        int key;
+        for (auto i = 0uz; i < datas.size(); ++i) {
+            if (t.keyOf(datas[i], key)) {
+                vs.emplace_back(key, contents[i]);
+            }
+        }
+        t.loadTable(vs);
+    } else { // string
+        int tableID = -1;
+        for (auto i = 0; i < (int)indexCache.sCaches.size(); ++i) {
+            if (indexCache.sCaches[i].database == database && indexCache.sCaches[i].name == tablename) {
+                if (indexCache.last == i) {
+                    indexCache.last = 3 - indexCache.last - indexCache.first;
+                    indexCache.first = i;
+                } else {
+                    indexCache.first = i;
+                }
+                tableID = i;
+                break;
+            }
+        }
+        if (tableID == -1) {
+            tableID = indexCache.last;
+            indexCache.sCaches[tableID].renew();
+            indexCache.sCaches[tableID].init(database, tablename);
+            indexCache.sCaches[tableID].openTable();
+            indexCache.last = 3 - indexCache.first - indexCache.last;
+            indexCache.first = tableID;
+        }
+        table<std::string> &t = indexCache.sCaches[tableID];
+        std::vector<bpT::bpTree<std::string>::keyValue> vs;
+        std::string key;
+        for (auto i = 0uz; i < datas.size(); ++i) {
+            if (t.keyOf(datas[i], key)) {
+                vs.emplace_back(key, contents[i]);
+            }
+        }
+        t.loadTable(vs);
+    }
+    times.end();
+    return true;
+}
@@ -123,4 +123,29 @@ bool DQL::selectRecord(const std::string &database, const std::vector<std::strin
     }
 
     return true;
-}
\ No newline at end of file
+}
+bool DQL::showPool(CPUTimer &times) {
+    auto &p = bpT::pool();
+    std::vector<std::string> props {"budget", "frames", "hits", "misses", "hit rate", "evictions",
+                                    "pages written", "bytes written", "syscalls saved", "readahead"};
+    size_t accesses = p.hitCount() + p.missCount();
+    std::vector<std::vector<std::string>> datas {{
+        std::to_string(p.budget() / 1024 / 1024) + "MB",
+        std::to_string(p.size()),
+        std::to_string(p.hitCount()),
+        std::to_string(p.missCount()),
+        accesses == 0 ? "-" : std::to_string(p.hitCount() * 100 / accesses) + "%",
+        std::to_string(p.evictCount()),
+        std::to_string(p.writeCount()),
+        std::to_string(p.bytesWritten()),
+        std::to_string(p.syscallsSaved()),
+        std::to_string(bpT::readaheadWindow()) + " pages",
+    }};
+    std::vector<int> widths;
+    for (auto i = 0uz; i < props.size(); ++i) {
+        widths.push_back((int)std::max(props[i].size(), datas[0][i].size()));
+    }
+    times.end();
+    draw_data(widths, props, datas);
+    return true;
+}
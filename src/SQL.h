@@ -53,6 +53,48 @@ bool createTable(const std::string &database, const std::string &tablename, cons
 * @return  false       失败
 */
 bool dropTable(const std::string &database, const std::string &tablename, CPUTimer &times);
+/**
+* @brief   整理表的数据文件
+* @param   database    数据库名
+* @param   tablename   表名
+* @param   mode        auto开启自动vacuum，manual关闭，为空则不改变
+* @param   times       计时器
+* @return  true        成功
+* @return  false       失败
+*/
+bool vacuumTable(const std::string &database, const std::string &tablename, const std::string &mode,
+                 cache<table> &indexCache, CPUTimer &times);
+/**
+* @brief   在表的一个或多个属性上创建二级索引
+* @param   database    数据库名
+* @param   indexname   索引名
+* @param   tablename   表名
+* @param   columns     属性名，多个属性时按前导属性优先排序
+* @param   hashed      是否为hash索引
+* @param   times       计时器
+* @return  true        成功
+* @return  false       失败
+*/
+bool createIndex(const std::string &database, const std::string &indexname, const std::string &tablename,
+                 const std::vector<std::string> &columns, bool hashed, cache<table> &indexCache,
+                 CPUTimer &times);
+/**
+* @brief   调整页缓冲池的内存预算
+* @param   megabytes   预算，单位MB
+* @param   times       计时器
+* @return  true        成功
+* @return  false       失败
+*/
+bool setPool(const std::string &megabytes, CPUTimer &times);
+
+/**
+* @brief   调整顺序扫描的预读窗口
+* @param   pages       窗口页数，0关闭顺序预读
+* @param   times       计时器
+* @return  true        成功
+* @return  false       失败
+*/
+bool setReadahead(const std::string &pages, CPUTimer &times);
 }
 
 namespace DML {
@@ -89,6 +131,17 @@ bool updateRecord(const std::string &database, const std::string &tablename, con
 */
 bool deleteRecord(const std::string &database, const std::string &tablename, const std::string &cmd,
                   cache<table> &indexCache, CPUTimer &times);
+/**
+* @brief   从文件批量导入记录，导入后批量重建索引
+* @param   database    数据库名
+* @param   tablename   表名
+* @param   filename    数据文件路径，每行一条记录，格式同insert的values
+* @param   times       计时器
+* @return  true        成功
+* @return  false       失败
+*/
+bool loadRecords(const std::string &database, const std::string &tablename, const std::string &filename,
+                 cache<table> &indexCache, CPUTimer &times);
 }
 
 /**
@@ -106,4 +159,11 @@ namespace DQL {
  */
 bool selectRecord(const std::string &database, const std::vector<std::string> &res, const std::string &cmd,
                   cache<table> &indexCache, CPUTimer &times);
+/**
+* @brief   显示页缓冲池的预算及命中、缺页、淘汰、写回计数，以及预读窗口
+* @param   times       计时器
+* @return  true        成功
+* @return  false       失败
+*/
+bool showPool(CPUTimer &times);
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+/**
+ * @file        bloomFilter.h
+ * @brief       分块Bloom过滤器
+ *              存放于索引文件旁的.bloom文件，页经页缓冲池读写：
+ *                  第0页：元数据（见bloomMeta）
+ *                  其后：位数组，按64字节（一个缓存行）分块，每页maxPageSize/64块
+ *              关键字的hash值选定一块，probes个位均落在该块内，一次判断只读取一页中的一个缓存行
+ *              只加入不删除，删除的关键字在重建前仍判断为可能存在；加入的关键字数超过容量时由调用方以两倍容量重建
+ *              文件缺失或无法识别时视为无效，由调用方根据索引重建，判断为不存在的关键字一定不存在
+ * @author      hjb
+ * @version     1.0
+ * @date        2023-12-15
+ * @copyright   Copyright (c) 2023
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "bufferPool.h"
+#include "dataMgr.h"
+
+namespace bpT {
+using namespace std;
+
+static const uint32_t bloomMagic = 0x4c424642; // "BFBL"
+
+/**
+* @brief   Bloom过滤器的元数据，位于第0页
+*/
+struct bloomMeta {
+    uint32_t magic = bloomMagic;
+    int32_t blocks = 0;     // 块数
+    int32_t capacity = 0;   // 按bitsPerKey计算的容量
+    int32_t count = 0;      // 自上次重建以来加入的关键字数
+};
+
+/**
+* @brief   分块Bloom过滤器
+*/
+class bloomFilter {
+private:
+    static constexpr int blockBytes = 64;                       // 块大小
+    static constexpr int blocksPerPage = maxPageSize / blockBytes;
+    static constexpr int bitsPerKey = 10;                       // 每个关键字占用的位数，误判率约1%
+    static constexpr int probes = 6;                            // 每个关键字置位的个数
+    static constexpr int minCapacity = 4096;
+
+    string filename = "";   // 过滤器文件路径
+    bloomMeta meta;         // 元数据页的副本，首次使用时读取，save时写回
+    bool loaded = false;    // meta是否已读取
+
+    void loadMeta() {
+        char *p = pool().fetch(filename, 0);
+        memcpy(&meta, p, sizeof(meta));
+        pool().unpin(filename, 0);
+        loaded = true;
+    }
+    void storeMeta() {
+        char *p = pool().fetch(filename, 0);
+        memcpy(p, &meta, sizeof(meta));
+        pool().unpin(filename, 0, true);
+    }
+
+    /**
+    * @brief   关键字的hash值（FNV-1a，再经fmix64混合）
+    */
+    static uint64_t hashOf(string_view k) {
+        uint64_t h = 14695981039346656037ull;
+        for (auto c : k) {
+            h = (h ^ (uint8_t)c) * 1099511628211ull;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /**
+    * @brief   依次处理关键字在其块内的各个位
+    * @param   k
+    * @param   dirty   是否修改该页
+    * @param   f       bool(uint8_t &byte, uint8_t mask)，返回false时停止
+    * @return  bool    全部位均返回true
+    */
+    template <typename F>
+    bool probe(string_view k, bool dirty, F f) {
+        uint64_t h = hashOf(k);
+        uint32_t block = (uint32_t)(((h >> 32) * (uint64_t)meta.blocks) >> 32);
+        int pageNo = 1 + block / blocksPerPage;
+        char *p = pool().fetch(filename, pageNo);
+        auto b = (uint8_t *)p + (block % blocksPerPage) * blockBytes;
+        uint32_t h1 = (uint32_t)h, h2 = (uint32_t)(h >> 17) | 1;
+        bool res = true;
+        for (auto i = 0; i < probes && res; ++i) {
+            uint32_t bit = (h1 + i * h2) % (blockBytes * 8);
+            res = f(b[bit / 8], (uint8_t)(1 << (bit % 8)));
+        }
+        pool().unpin(filename, pageNo, dirty);
+        return res;
+    }
+
+public:
+    void init(const string &filename) {
+        this->filename = filename;
+        loaded = false;
+    }
+
+    /**
+    * @brief   过滤器是否可用
+    */
+    bool valid() {
+        if (!loaded) {
+            loadMeta();
+        }
+        return meta.magic == bloomMagic && meta.blocks > 0;
+    }
+
+    /**
+    * @brief   清空过滤器，按容量重新分配位数组
+    * @param   n   预计的关键字数
+    */
+    void reset(size_t n) {
+        n = max(n, (size_t)minCapacity);
+        pool().truncate(filename, 0);
+        meta = bloomMeta {};
+        meta.capacity = n;
+        meta.blocks = (n * bitsPerKey + blockBytes * 8 - 1) / (blockBytes * 8);
+        loaded = true;
+    }
+
+    /**
+    * @brief   加入关键字，调用前须经valid或reset确认过滤器可用
+    * @param   k
+    */
+    void add(string_view k) {
+        probe(k, true, [](uint8_t &byte, uint8_t mask) {
+            byte |= mask;
+            return true;
+        });
+        meta.count++;
+    }
+
+    /**
+    * @brief   关键字是否可能存在，返回false时一定不存在
+    * @param   k
+    */
+    bool mayContain(string_view k) {
+        return probe(k, false, [](uint8_t &byte, uint8_t mask) { return (byte & mask) != 0; });
+    }
+
+    /**
+    * @brief   加入的关键字数是否已超过容量，超过时误判率上升，应以两倍容量重建
+    */
+    bool full() {
+        return meta.count > meta.capacity;
+    }
+    int size() {
+        return meta.count;
+    }
+
+    /**
+    * @brief   写入元数据页，再将过滤器的脏页写回磁盘
+    * @return  true    成功
+    * @return  false   写入失败，见bufferPool::flush
+    */
+    bool save() {
+        if (loaded && valid()) {
+            storeMeta();
+        }
+        return pool().flush(filename);
+    }
+
+    /**
+    * @brief   删除过滤器文件
+    */
+    void drop() {
+        pool().discard(filename);
+        std::remove(filename.c_str());
+        meta = bloomMeta {};
+        loaded = false;
+    }
+};
+}
@@ -1,6 +1,29 @@
 /**
  * @file        bpTree.h
  * @brief       b+树
+ *              节点为.ind文件中的页，经页缓冲池按需读入，页格式见nodePage.h
+ *              打开表时不读取索引，内存占用受缓冲池预算限制
+ *              扇出：
+ *                  节点容纳的关键字数由页大小及关键字宽度决定，int主键每个节点约1000个关键字，
+ *                  string主键按关键字实际长度填满页；节点内以二分查找定位，自根向下迭代查找
+ *                  在最右叶子节点末尾追加时不平分节点，而是将新关键字单独放入新节点，顺序插入时节点保持填满
+ *              组合主键：
+ *                  以各主键属性的保序编码（见keyCodec.h）拼接为string主键
+ *              string主键：
+ *                  叶子节点分裂时上移的分隔关键字只取区分左右两侧所需的最短前缀（后缀截断），内部节点因此存放更多关键字
+ *                  叶子节点提出各关键字的公共前缀，只存放并比较后缀
+ *              子节点以页号链接，叶子节点以next/prev串成双向链表；
+ *              不在页中保存父节点页号，插入、删除时记录自根向下的路径，分裂与删除沿路径向上处理
+ *              删除：叶子节点为空时从链表及父节点中摘除，不与兄弟节点借位或合并，
+ *                  内部节点只剩一个子节点时保留，根节点只剩一个子节点时树降低一层
+ *              批量建树：
+ *                  关键字排序后按填充率依次填满叶子节点，再由各节点的首个分隔关键字自底向上逐层构造内部节点，
+ *                  叶子节点的页号连续；用于批量导入、vacuum后改写rid及.ind缺失或无法识别时由.dat重建
+ *              Bloom过滤器：
+ *                  开启后主键另存于.ind旁的.bloom（见bloomFilter.h），查找前先经过滤器判断，一定不存在的主键不自根向下查找，
+ *                  插入新主键时省去查重的一次查找；建树时随之重建，文件缺失或超出容量时由叶子节点中的主键重建
+ *              只读取索引的查找：
+ *                  find_keys只沿叶子链表取得主键及rid，不读取数据文件，语句只涉及主键属性时由调用方直接以主键作答
  * @author      hjb
  * @version     1.0
  * @date        2023-11-21
@@ -10,21 +33,20 @@
 #pragma once
 
 #include <filesystem>
-#include <fstream>
 #include <iostream>
-#include <format>
-#include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 #include <algorithm>
 #include "type_traits.h"
+#include "bloomFilter.h"
 #include "dataMgr.h"
+#include "keyCodec.h"
+#include "nodePage.h"
 
 namespace bpT {
 using namespace std;
 
-enum printType {KEY, DINDEX, ROOT, INDEX};
-
 /**
 * @brief   b+Tree
 */
@@ -33,17 +55,13 @@ class bpTree {
     /*
     * eg.
     *    input: {3,-9}, {5, 8}, {8, 1}, {6, 4}, {0, 10}, {9, 13}, {1, 1}
-    *    build:
-    *      node:              +------- 6 -------+
-    *                        /                   \
-    *               +-- 1 --+-- 5 --+          +- 8 -+
-    *              /        |        \        /       \
-    *           | 0 |   | 1 | 3 |   | 5 |  | 6 |   | 8 | 9 |
-    *           x - x   x - x - x   x - x  x - x   x - x - x
-    *             |       |   |       |      |       |   |
-    *       head :0>>>>>>>>>1>>>>>>>>>5>>>>>>6>>>>>>>>>8>>>>tail
-    *             |       |   |       |      |       |   |
-    *      indexs:4       6   0       1      3       2   5
+    *    build（示意，每个节点最多2个关键字，[n]为页号）:
+    *      node:                  [7] 6
+    *                        /            \
+    *              [3] 3 | 5               [6] 8
+    *             /      |     \           /     \
+    *      [1] 0 | 1   [8] 3   [5] 5   [4] 6   [2] 8 | 9
+    *      leaf:  head [1] <=> [8] <=> [5] <=> [4] <=> [2] tail
     */
 public:
     /**
@@ -70,85 +88,53 @@ public:
             return this->key > v.key;
         }
     };
-private:
-    /**
-    * @brief    树节点
-    */
-    struct _node {
-        using value_type = pair<typename keyValue::key_type, int>;
 
-        vector<value_type> vals; // 节点key
-        vector<_node *> nodes;   // 节点子节点
-        int index; // 叶子节点对应leafs数组下标
-        bool isLeaf; // 叶子节点标志
-        _node() {
-            vals.reserve(8);
-            nodes.reserve(8);
-            nodes.push_back(nullptr);
-            index = -1;
-            isLeaf = false;
-        }
-        _node(value_type v) : _node() {
-            vals.push_back(v);
-            nodes.push_back(nullptr);
-        }
-        void push_back(value_type v) {
-            vals.push_back(v);
-            nodes.push_back(nullptr);
-        }
-        void push_back() {
-            vals.push_back(value_type{});
-            nodes.push_back(nullptr);
-        }
-    };
+public:
+    using node = nodePage<T>;
+    using key_ref = node::key_ref;
+    using data_type = keyValue::data_type;
+    using key_type = T;
+    using node_value_t = pair<key_type, int>;
 
+private:
     /**
-    * @brief   叶子节点封装
+    * @brief   被pin住的节点页，析构时释放
     */
-    struct _leaf {
-        _node *leaf;
-        _leaf *next;
-        //int data;
-        _leaf() {
-            this->leaf = nullptr;
-            this->next = nullptr;
+    struct pinned {
+        const string &file;
+        int pageNo;
+        node n;
+        bool dirty = false;
+
+        pinned(const string &file, int pageNo) : file(file), pageNo(pageNo), n(pool().fetch(file, pageNo)) {}
+        pinned(const pinned &) = delete;
+        ~pinned() noexcept {
+            pool().unpin(file, pageNo, dirty);
         }
-        _leaf(_node *&node) : _leaf() {
-            this->leaf = &(*(node));
+        node *operator->() {
+            return &n;
         }
     };
 
 public:
-    using node = _node;
-    using node_ptr = node*;
-    using leaf = _leaf;
-    using leaf_ptr = leaf*;
-
-    using data_type = keyValue::data_type;
-    using key_type = T;
-    using node_value_t = node::value_type;
-
-public:
-    vector<leaf_ptr> leafs; // 对叶子节点进行包装，方便直接对其访问
-    vector<bool> indexs;    // 某位置的数据是否已被删除（按插入时间顺序排序）
     dataMgr dm;             // 辅助类，对用户磁盘进行操作
 
 protected:
-    node_ptr root;  // 树的根节点
-    int m = 3; // b+树阶数，必须大于2
-    int min_num, max_num; // 每个节点拥有的最小/最大数据块数（根节点及叶子节点例外）
+    indexMeta meta;         // 元数据页的副本，每次操作前从缓冲池读取
+    string filename = dataPos + "db/" + "table.ind";    // 表的ind文件路径
+    keyCodec keyColumns;    // 主键在行中的属性下标，由.dat重建索引时使用，为空表示不重建；多于一个时为组合主键
+    bloomFilter bloom;      // 主键的Bloom过滤器
+    bool filtered = false;  // 是否使用Bloom过滤器
 
 public:
     string database = "db"; // 数据库名
     string table = "table";    // 表名
 
-    leaf_ptr head, tail;    // 叶子节点的首位及末位的后一位
-
     bpTree() {
         dm.setKeyType(keyTypeIsString<key_type>);
     };
-    bpTree(string database, string table, int m = 3) noexcept {
-        init(database, table, m);
+    bpTree(string database, string table) noexcept {
+        init(database, table);
     }
     ~bpTree() noexcept {
         clear();
@@ -158,1012 +144,804 @@ public:
 
 private:
     /**
-    * @brief   辅助fission函数
-    * @param   p       节点
-    * @param   _lr     新的左节点的引用
-    * @param   _rr     新的右节点的引用
-    * @param   half    待求中间值位置
+    * @brief   读取元数据页，索引文件不存在、无法识别或版本不符时由数据文件重建
     */
-    void _fission(node_ptr &p, node_ptr &_lr, node_ptr &_rr, int &half) {
-        half = (m - 1) / 2;
-        _lr = new node;
-        _rr = new node;
-        // 将节点的vals分为[0~half-1, half, half+1~m-1]三部分
-        _lr->nodes[0] = p->nodes[0];
-        for (auto i = 0; i < half; ++i) {
-            _lr->push_back(p->vals[i]);
-            _lr->nodes[i + 1] = p->nodes[i + 1];
-        }
-        if (p->isLeaf) {
-            _rr->nodes[0] = p->nodes[half];
-            _rr->push_back(p->vals[half]);
-        }
-        for (auto i = half + 1; i < m; ++i) {
-            _rr->nodes[i - half - 1] = p->nodes[i];
-            _rr->push_back(p->vals[i]);
-        }
-        _rr->nodes.back() = p->nodes.back();
-        _lr->isLeaf = p->isLeaf;
-        _rr->isLeaf = p->isLeaf;
+    void loadMeta() {
+        if (valid()) {
+            return;
+        }
+        vector<node_value_t> es;
+        if (!keyColumns.columns.empty()) {
+            dm.scanRecords([&](int rid, const rowView &row) {
+                es.emplace_back(rowKey(row), rid);
+            });
+        }
+        build(es);
+    }
+    void storeMeta() {
+        char *p = pool().fetch(filename, 0);
+        memcpy(p, &meta, sizeof(meta));
+        pool().unpin(filename, 0, true);
     }
 
     /**
-    * @brief   前序遍历替代层序遍历，为方便显示层结构未直接使用队列层序遍历
-    * @param   r       节点
-    * @param   v       存储层节点的数组
-    * @param   depth   当前递归深度
+    * @brief   分配一个节点页，优先复用空闲页
+    * @param   leaf    是否为叶子节点
+    * @return  int     页号
     */
-    void _levelOrder(node_ptr r, vector<vector<node_ptr>> &v, size_t depth = 0) {
-        if (r == nullptr)
-            return;
-        // 前序遍历，将当前层所有节点压入存储数组的对应位置
-        if (v.size() <= depth)
-            v.push_back(vector<node_ptr> {r});
-        else
-            v[depth].push_back(r);
-        for (auto i : r->nodes) {
-            _levelOrder(i, v, depth + 1);
+    int allocPage(bool leaf) {
+        int pageNo = meta.freeList != -1 ? meta.freeList : pool().pageCount(filename);
+        pinned p(filename, pageNo);
+        if (pageNo == meta.freeList) {
+            meta.freeList = p->next();
         }
+        p->format(leaf);
+        p.dirty = true;
+        return pageNo;
+    }
+    /**
+    * @brief   释放节点页，加入空闲页链表
+    * @param   pageNo
+    */
+    void freePage(int pageNo) {
+        pinned p(filename, pageNo);
+        p->format(false);
+        p->setNext(meta.freeList);
+        p.dirty = true;
+        meta.freeList = pageNo;
     }
 
     /**
-    * @brief   辅助erase函数，与右侧最近关键字交换
-    * @param   r_swap      递归节点
-    * @param   v_delete    带有v的原节点
+    * @brief   自[from, es.size())起按填充率及页内空间选取填入一个节点的关键字
+    * @param   es
+    * @param   from
+    * @param   fill    填充率
+    * @return  size_t  结束位置，至少选取一个关键字
     */
-    void _swap(node_ptr &r_swap, node_value_t &v_delete) {
-        // 优先与右最近关键字交换
-        if (r_swap->isLeaf) {
-            auto _tmp = v_delete;
-            v_delete = r_swap->vals.front();
-            r_swap->vals.insert(r_swap->vals.begin(), _tmp);
-            r_swap->nodes.push_back(nullptr);
-            return;
+    static size_t packEnd(const vector<node_value_t> &es, size_t from, double fill) {
+        size_t budget = fill * (maxPageSize - sizeof(nodeHeader)), used = 0, to = from;
+        while (to < es.size() && (to == from || used + node::entrySize(es[to].first) <= budget)) {
+            used += node::entrySize(es[to++].first);
         }
-        _swap(r_swap->nodes.front(), v_delete);
+        return to;
     }
 
-protected:
     /**
-    * @brief   节点分裂
-    * @param   r   节点
+    * @brief   丢弃原有索引页，由关键字自底向上批量建树
+    * @param   es      关键字及rid，关键字相同时保留最后一个
+    * @param   fill    节点填充率
     */
-    void fission(node_ptr &r) {
-        if (r == nullptr)
-            return;
-        if (r == root) { // 根节点，直接向上生长一层，不考虑对树结构的影响
-            auto &p = r;
-            if (p == nullptr)
-                return;
-            if ((int)p->nodes.size() > m) {
-                node_ptr _lr, _rr;
-                int half;
-                auto p_index = p->index;
-                _fission(p, _lr, _rr, half);
-                auto _r = new node(r->vals[half]);
-                _r->nodes[0] = _lr;
-                _r->nodes[1] = _rr;
-                auto _p = p;
-                p = _r;
-
-                delete _p;
-                _p = nullptr;
-
-                if (_lr->isLeaf) { // 将新插入的叶子节点加入到leafs中
-                    leafs[p_index]->leaf = &(*(r->nodes[0]));
-                    auto __q = new leaf(r->nodes[1]);
-                    __q->next = leafs[p_index]->next;
-                    leafs[p_index]->next = __q;
-                    r->nodes[0]->index = p_index;
-                    r->nodes[1]->index = leafs.size();
-                    leafs.push_back(__q);
-                }
-                return;
+    void build(vector<node_value_t> &es, double fill = bulkFill) {
+        stable_sort(es.begin(), es.end(), [](auto &a, auto &b) { return a.first < b.first; });
+        auto last = es.begin();
+        for (auto i = es.begin(); i != es.end(); ++i) {
+            if (i + 1 != es.end() && !(i->first < (i + 1)->first)) {
+                continue;
+            }
+            if (last != i) {
+                *last = std::move(*i);
             }
+            ++last;
         }
-        // 非根节点，将中间值插入父节点，该节点分裂为两份
-        auto n = r->nodes.size();
-        for (auto k = 0uz; k < n; ++k) {
-            auto &p = r->nodes[k];
-            if (p == nullptr)
-                continue;
-            if ((int)p->nodes.size() > m) {
-                node_ptr _lr, _rr;
-                int half;
-                auto p_index = p->index;
-                _fission(p, _lr, _rr, half);
-                r->vals.push_back(p->vals[half]);
-                sort(r->vals.begin(), r->vals.end());
-                auto _p = p;
-                p = _lr;
-                r->nodes.insert(r->nodes.begin() + k + 1, _rr);
-                delete _p;
-                _p = nullptr;
+        es.erase(last, es.end());
 
-                if (r->nodes[k]->isLeaf) { // 将新插入的叶子节点加入到leafs中
-                    leafs[p_index]->leaf = &(*(r->nodes[k]));
-                    auto __q = new leaf(r->nodes[k + 1]);
-                    __q->next = leafs[p_index]->next;
-                    leafs[p_index]->next = __q;
-                    r->nodes[k]->index = p_index;
-                    r->nodes[k + 1]->index = leafs.size();
-                    leafs.push_back(__q);
+        pool().truncate(filename, 0);
+        meta = indexMeta{};
+        meta.keyKind = keyTypeIsString<key_type>;
+        storeMeta();
+        meta.head = meta.tail = meta.root = allocPage(true);
+        // 叶子节点，level中记录每个节点的页号及其左侧的分隔关键字
+        vector<node_value_t> level;
+        for (size_t from = 0; from < es.size();) {
+            int pageNo = level.empty() ? meta.head : allocPage(true);
+            pinned p(filename, pageNo);
+            p.dirty = true;
+            size_t to = packEnd(es, from, fill);
+            p->clear(es[from].first, es[to - 1].first);
+            size_t i = from;
+            for (; i < to && p->fits(es[i].first); ++i) {
+                p->insert(p->count(), es[i].first, es[i].second);
+            }
+            if (!level.empty()) {
+                pinned q(filename, meta.tail);
+                q->setNext(pageNo);
+                q.dirty = true;
+                p->setPrev(meta.tail);
+                level.emplace_back(node::separator(es[from - 1].first, es[from].first), pageNo);
+            } else {
+                level.emplace_back(key_type{}, pageNo);
+            }
+            meta.tail = pageNo;
+            from = i;
+        }
+        // 内部节点，每个节点的首个子节点存入first，其分隔关键字随节点上移
+        while (level.size() > 1) {
+            vector<node_value_t> upper;
+            for (size_t from = 0; from < level.size();) {
+                int pageNo = allocPage(false);
+                pinned p(filename, pageNo);
+                p.dirty = true;
+                p->header()->first = level[from].second;
+                size_t to = packEnd(level, from + 1, fill);
+                size_t i = from + 1;
+                for (; i < to && p->fits(level[i].first); ++i) {
+                    p->insert(p->count(), level[i].first, level[i].second);
                 }
+                upper.emplace_back(std::move(level[from].first), pageNo);
+                from = i;
+            }
+            level = std::move(upper);
+            meta.height++;
+        }
+        if (!level.empty()) {
+            meta.root = level[0].second;
+        }
+        storeMeta();
+        if (filtered) {
+            bloom.reset(es.size() * 2);
+            for (auto &e : es) {
+                bloom.add(keyBytes(e.first));
             }
         }
     }
 
     /**
-    * @brief   插入节点
-    * @param   r   节点
-    * @param   v   关键字
+    * @brief   内部节点的第i个子节点页号
     */
-    void _insert(node_ptr &r, node_value_t &v, int &_pos) {
-        if (r == nullptr) { // 新创建一个节点
-            r = new node(v);
-            r->isLeaf = true;
-            // 将新插入的节点当作head节点，并设置head在leafs中的索引
-            head->leaf = &(*(r));
-            r->index = 0;
-            return;
-        }
-        if (r->isLeaf) { // 叶子节点，按顺序插入
-            auto n = r->vals.size();
-            if (n == 1) {
-                if (r->vals[0].first == v.first) { // 相同key，直接替换值
-                    //r->vals[0].second = v.second;
-                    _pos = r->vals[0].second;
-                    return;
-                }
-                if (r->vals[0].first < v.first) {
-                    r->vals.insert(r->vals.begin() + 1, v);
-                    r->nodes.push_back(nullptr);
-                } else {
-                    r->vals.insert(r->vals.begin(), v);
-                    r->nodes.push_back(nullptr);
-                }
-            } else {
-                for (auto i = 0uz; i < n - 1; ++i) {
-                    if (v.first < r->vals[0].first) {
-                        r->vals.insert(r->vals.begin(), v);
-                        r->nodes.push_back(nullptr);
-                    } else if (v.first == r->vals[0].first) { // 相同key，直接替换值
-                        _pos = r->vals[0].second;
-                        return;
-                    } else if (v.first >= r->vals[n - 1].first) {
-                        if (r->vals[n - 1].first == v.first) { // 相同key，直接替换值
-                            //r->vals[n - 1].second = v.second;
-                            _pos = r->vals[n - 1].second;
-                            return;
-                        }
-                        r->push_back(v);
-                        break;
-                    } else if (r->vals[i].first < v.first && r->vals[i + 1].first >= v.first) {
-                        if (r->vals[i + 1].first == v.first) { // 相同key，直接替换值
-                            //r->vals[i + 1].second = v.second;
-                            _pos = r->vals[i + 1].second;
-                            return;
-                        }
-                        r->vals.insert(r->vals.begin() + i + 1, v);
-                        r->nodes.push_back(nullptr);
-                        break;
-                    }
-                }
-            }
-            return;
-        }
-        if (v.first == r->vals[0].first) { // 相同key，直接替换值
-            //r->vals[0].second = v.second;
-            if (!r->isLeaf)
-                _insert(r->nodes[1], v, _pos);
-            return;
-        }
-        if (v.first < r->vals[0].first) { // 转向最左边
-            _insert(r->nodes[0], v, _pos);
-        } else if (v.first >= r->vals.back().first) { // 转向最右边
-            if (v.first == r->vals.back().first) { // 相同key，直接替换值
-                //r->vals.back().second = v.second;
-                if (!r->isLeaf)
-                    _insert(r->nodes.back(), v, _pos);
-                return;
+    static int child(node &n, int i) {
+        return i == 0 ? n.header()->first : n.val(i - 1);
+    }
+    /**
+    * @brief   自根节点向下查找关键字所在的叶子节点
+    * @param   k       关键字
+    * @param   path    输出，经过的内部节点页号及进入的子节点下标
+    * @return  int     叶子节点页号
+    */
+    int descend(const key_type &k, vector<pair<int, int>> *path = nullptr) {
+        int pageNo = meta.root;
+        while (true) {
+            pinned p(filename, pageNo);
+            if (p->isLeaf()) {
+                return pageNo;
             }
-            _insert(r->nodes.back(), v, _pos);
-        } else {
-            for (auto i = 1uz; i < r->vals.size(); ++i) {
-                if (v.first == r->vals[i - 1].first) { // 相同key，直接替换值
-                    //r->vals[i].second = v.second;
-                    if (!r->isLeaf)
-                        _insert(r->nodes[i], v, _pos);
-                    return;
-                }
-                if (v.first >= r->vals[i - 1].first && v.first < r->vals[i].first) { // 转向下一层
-                    _insert(r->nodes[i], v, _pos);
-                }
+            int i = p->upperBound(k);
+            if (path != nullptr) {
+                path->emplace_back(pageNo, i);
             }
+            pageNo = child(p.n, i);
         }
-        // 分裂
-        fission(r);
     }
+
     /**
-    * @brief   对_insert的封装
-    * @param   v
+    * @brief   查找关键字
+    * @param   k
+    * @param   rid     输出，关键字对应的rid
+    * @return  true    存在
+    * @return  false   不存在
     */
-    void insert(node_value_t v, int &_pos) {
-        // 插入并修正
-        _insert(root, v, _pos);
-        fission(root);
+    bool lookup(const key_type &k, int &rid) {
+        if (!mayContain(k)) {
+            return false;
+        }
+        pinned p(filename, descend(k));
+        int i = p->lowerBound(k);
+        if (i < p->count() && p->equals(i, k)) {
+            rid = p->val(i);
+            return true;
+        }
+        return false;
     }
 
     /**
-    * @brief   删除节点（删除叶子节点或非叶子节点）
-    * @param   r       传入节点
-    * @param   v       删除节点值
-    * @param   _found  是否找到
-    * @return  0       处理完毕
-    * @return  1       待处理
-    * @return  2       上一次查找结果
+    * @brief   自leafNo叶子节点的第i个关键字起沿叶子链表遍历，f返回false时停止
+    * @param   leafNo
+    * @param   i
+    * @param   f       bool(key_ref, int)
     */
-    int _erase(node_ptr &r, key_type v, bool &_found, bool &_first) {
-        if (r == nullptr) {
-            return 0;
-        }
-        bool found = false;
-        for (auto i = 0uz; i < r->vals.size(); ++i) {
-            if (v == r->vals[i].first) {
-                if (!r->isLeaf) { // 非根节点
-                    if (!_first) { // 叶子节点的值还未删除，先删除叶子节点
-                        // 转向右节点
-                        auto _res = _erase(r->nodes[i + 1], v, _found, _first);
-                        if (_res == 2) {
-                            found = true;
-                            _first = true;
-                            break;
-                        } else {
-                            break;
-                        }
-                    }
-                    // 将v与key值最接近的右关键字交换位置，进入右分支后删除已是叶子节点的v
-                    _swap(r->nodes[i + 1], r->vals[i]);
-                    auto _res = _erase(r->nodes[i + 1], v, _found, _first);
-                    if (_res == 2) {
-                        found = true;
-                        _first = true;
-                        break;
-                    } else if (_res == 0) {
-                        break;
-                    }
-                } else { // 找到该叶子节点，返回到父亲节点
-                    _found = true;
-                    if (r->vals[i].second > 0) {
-                        indexs[r->vals[i].second] = false;
-                    }
-                    return 2;
+    template <typename F>
+    void walk(int leafNo, int i, F f) {
+        while (leafNo != -1) {
+            pinned p(filename, leafNo);
+            for (; i < p->count(); ++i) {
+                if (!f(p->key(i), p->val(i))) {
+                    return;
                 }
             }
+            leafNo = p->next();
+            i = 0;
         }
-        for (auto i = 0uz; i <= r->vals.size(); ++i) { // 查找v
-            if (i == 0) { // 进入第一个子节点
-                if (v < r->vals.front().first) {
-                    auto _res = _erase(r->nodes.front(), v, _found, _first);
-                    if (_res == 2) {
-                        found = true;
-                        _first = true;
-                        break;
-                    } else if (_res == 0) {
-                        break;
-                    }
-                }
-            } else if (i == r->vals.size()) { // 进入最后一个子节点
-                if (v >= r->vals.back().first) {
-                    auto _res = _erase(r->nodes.back(), v, _found, _first);
-                    if (_res == 2) {
-                        found = true;
-                        _first = true;
-                        break;
-                    } else if (_res == 0) {
-                        break;
-                    }
-                }
-            } else { // 进入中间节点
-                if (v >= r->vals[i - 1].first && v < r->vals[i].first) {
-                    auto _res = _erase(r->nodes[i], v, _found, _first);
-                    if (_res == 2) {
-                        found = true;
-                        _first = true;
-                        break;
-                    } else if (_res == 0) {
-                        break;
-                    }
-                }
-            }
+    }
+
+    static vector<node_value_t> entries(node &n) {
+        vector<node_value_t> es;
+        es.reserve(n.count() + 1);
+        for (auto i = 0; i < n.count(); ++i) {
+            es.emplace_back(key_type(n.key(i)), n.val(i));
         }
-        // 查找结束，检测该树是否存在v
-        if (found) { // r为所寻节点的父节点
-            // 找到要处理的节点 r->nodes[i]
-            int pos = -1;
-            int n = r->nodes.size();
-            for (auto i = 0; i < n; ++i) {
-                for (auto j : r->nodes[i]->vals) {
-                    if (j.first == v) {
-                        pos = i;
-                        break;
-                    }
-                }
-                if (pos != -1)
-                    break;
-            }
-            // 标记其兄弟节点
-            int lb = pos == 0 ? -1 : pos - 1;
-            int rb = pos == n - 1 ? -1 : pos + 1;
-            auto check2 = [this](node_value_t &p, node_ptr & p_r)->bool{
-                return (p.first != p_r->vals.front().first) || ((p.first == p_r->vals.front().first)
-                        && ((int)p_r->vals.size() - 1 > min_num));
-            };
-            // 1、自身富裕
-            if ((int)r->nodes[pos]->vals.size() > min_num) { // 直接删除自身一个节点，处理完毕
-                // cout << "自身富裕" << endl;
-                // 删除v
-                int _pos = -1;
-                auto &q = r->nodes[pos];
-                for (auto i = 0uz; i < q->vals.size(); ++i) {
-                    if (q->vals[i].first == v) {
-                        _pos = i;
-                        break;
-                    }
-                }
-                q->vals.erase(q->vals.begin() + _pos);
-                q->nodes.pop_back();
-                return 0;
-            }
-            // 2、右兄弟富裕
-            else if (rb > -1 && (int)r->nodes[rb]->vals.size() > min_num && check2(r->vals[pos], r->nodes[rb])) { // 摘下右兄弟的一个节点，处理完毕
-                // cout << "右兄弟富裕" << endl;
-                bool _eq = (r->vals[pos].first == r->nodes[rb]->vals.front().first);
-                if (_eq) {
-                    r->nodes[rb]->vals.erase(r->nodes[rb]->vals.begin());
-                    r->nodes[rb]->nodes.erase(r->nodes[rb]->nodes.begin());
-                }
-                // 从右兄弟处取走第一个值
-                auto rv = r->nodes[rb]->vals.front();
-                r->nodes[rb]->vals.erase(r->nodes[rb]->vals.begin());
-                r->nodes[rb]->nodes.pop_back();
-                // 将来自右兄弟的值交给父节点
-                auto hv = r->vals[pos];
-                r->vals[pos] = rv;
-                // 删除v，并用来自父节点的值替代v
-                int _pos = -1;
-                auto &q = r->nodes[pos];
-                q->vals.push_back(hv);
-                for (auto i = 0uz; i < q->vals.size(); ++i) {
-                    if (q->vals[i].first == v) {
-                        _pos = i;
-                        break;
-                    }
-                }
-                q->vals.erase(q->vals.begin() + _pos);
-                if (_eq) {
-                    r->nodes[rb]->vals.insert(r->nodes[rb]->vals.begin(), r->vals[pos]);
-                    r->nodes[rb]->nodes.push_back(nullptr);
-                }
-                return 0;
-            }
-            // 3、左兄弟富裕
-            else if (lb > -1 && (int)r->nodes[lb]->vals.size() > min_num) { // 摘下左兄弟的一个节点，处理完毕
-                // cout << "左兄弟富裕" << endl;
-                // 从左兄弟处取走最后一个值
-                auto lv = r->nodes[lb]->vals.back();
-                r->nodes[lb]->vals.pop_back();
-                r->nodes[lb]->nodes.pop_back();
-                // 将来自左兄弟的值交给父节点
-                auto hv = r->vals[lb];
-                r->vals[lb] = lv;
-                // 删除v，并用来自父节点的值替代v
-                int _pos = -1;
-                auto &q = r->nodes[pos];
-                q->vals.insert(q->vals.begin(), hv);
-                for (auto i = 0uz; i < q->vals.size(); ++i) {
-                    if (q->vals[i].first == v) {
-                        _pos = i;
-                        break;
-                    }
-                }
-                q->vals.erase(q->vals.begin() + _pos);
-                if (r->vals[lb].first != q->vals.front().first) {
-                    q->vals.insert(q->vals.begin(), r->vals[lb]);
-                    q->nodes.push_back(nullptr);
-                }
-                return 0;
-            }
-            // 4、父亲富裕或不富裕（若导致节点缺少，直接抛给上级节点处理）
-            else { // 摘下父亲的一个节点，处理完毕
-                // cout << "父亲富裕" << endl;
-                bool _eq = false;
-                // 删除v
-                int _pos = -1;
-                auto &q = r->nodes[pos];
-                for (auto i = 0uz; i < q->vals.size(); ++i) {
-                    if (q->vals[i].first == v) {
-                        _pos = i;
-                        break;
-                    }
-                }
-                q->vals.erase(q->vals.begin() + _pos);
-                q->nodes.pop_back();
-                // 合并
-                if (rb > -1) { // 向右合并
-                    _eq = (r->vals[pos].first == r->nodes[rb]->vals.front().first);
-                    auto p_index = r->nodes[pos]->index;
-                    if (r->nodes[pos]->isLeaf) { // 修正leafs节点对叶子节点的链接
-                        auto __p = leafs[p_index]->next;
-                        leafs[p_index]->next = __p->next;
-                        delete __p;
-                        __p = nullptr;
-                    }
-                    auto hv = r->vals[pos];
-                    auto lp = r->nodes[pos];
-                    auto rp = r->nodes[rb];
-                    if (_eq) {
-                        lp->nodes.pop_back();
-                    } else {
-                        lp->vals.push_back(hv);
-                    }
-                    for (auto i : rp->vals) {
-                        lp->vals.push_back(i);
-                    }
-                    for (auto i : rp->nodes) {
-                        lp->nodes.push_back(i);
-                    }
-                    r->vals.erase(r->vals.begin() + pos);
-                    r->nodes.erase(r->nodes.begin() + rb);
-                    delete rp;
-                    rp = nullptr;
-                } else if (lb > -1) { // 向左合并
-                    _eq = (r->vals[lb].first == r->nodes[pos]->vals.front().first);
-                    // auto p_index = r->nodes[pos]->index;
-                    // if (r->nodes[pos]->isLeaf) { // 修正leafs节点对叶子节点的链接
-                    //     auto __p = leafs[p_index]->next;
-                    //     leafs[p_index]->leaf = __p->leaf;
-                    //     leafs[p_index]->next = __p->next;
-                    //     delete __p;
-                    //     swap(leafs[p_index], __p);
-                    // }
-                    auto p_index = r->nodes[lb]->index;
-                    if (r->nodes[lb]->isLeaf) { // 修正leafs节点对叶子节点的链接
-                        auto __p = leafs[p_index]->next;
-                        leafs[p_index]->next = __p->next;
-                        delete __p;
-                        __p = nullptr;
-                    }
-                    auto hv = r->vals[lb];
-                    auto lp = r->nodes[lb];
-                    auto rp = r->nodes[pos];
-                    if (_eq) {
-                        lp->nodes.pop_back();
-                    } else {
-                        lp->vals.push_back(hv);
-                    }
-                    for (auto i : rp->vals) {
-                        lp->vals.push_back(i);
-                    }
-                    for (auto i : rp->nodes) {
-                        lp->nodes.push_back(i);
-                    }
-                    r->vals.erase(r->vals.begin() + lb);
-                    r->nodes.erase(r->nodes.begin() + pos);
-                    delete rp;
-                    rp = nullptr;
-                }
-                if (r == root && r->vals.size() == 0) { // 若树只有两层且根节点原本只有1个关键字，处理后根节点会没有值，直接减掉一层
-                    auto _r = r;
-                    r = r->nodes.front();
-                    head->leaf = r;
-                    head->next = tail;
-                    delete _r;
-                    _r = nullptr;
-                    return 0;
-                }
-                if ((int)r->vals.size() > min_num)
-                    return 0;
-                else
-                    return 1;
-            }
+        return es;
+    }
+    static void refill(node &n, const vector<node_value_t> &es, size_t from, size_t to) {
+        n.clear(es[from].first, es[to - 1].first);
+        for (auto i = from; i < to; ++i) {
+            n.insert(n.count(), es[i].first, es[i].second);
         }
-        // 对上次递归抛出的中间层节点关键字数目缺失进行处理，此时不可能为叶子节点
-        if (_found && !r->isLeaf) {
-            int n = r->nodes.size();
-            bool lack = false;
-            int pos = -1;
-            for (auto i = 0; i < n; ++i) {
-                if ((int)r->nodes[i]->vals.size() < min_num) {
-                    pos = i;
-                    lack = true;
-                    break;
-                }
-            }
-            if (lack) { // r为上次处理节点p的父节点的父节点, 子节点贫穷
-                // 标记p父节点的兄弟节点
-                int lb = pos == 0 ? -1 : pos - 1;
-                int rb = pos == n - 1 ? -1 : pos + 1;
-                // 1、p父节点的右兄弟富裕
-                if (rb > -1 && (int)r->nodes[rb]->vals.size() > min_num) { // 摘下右兄弟一个节点，处理完毕
-                    // cout << "右叔叔富裕" << endl;
-                    // 从右兄弟处取走第一个值
-                    auto rv = r->nodes[rb]->vals.front();
-                    r->nodes[rb]->vals.erase(r->nodes[rb]->vals.begin());
-                    auto rn = r->nodes[rb]->nodes.front();
-                    r->nodes[rb]->nodes.erase(r->nodes[rb]->nodes.begin());
-                    // 将来自右兄弟的值交给父节点
-                    auto hv = r->vals[pos];
-                    r->vals[pos] = rv;
-                    // 插入来自父节点的值，接入来自右兄弟的节点
-                    auto &q = r->nodes[pos];
-                    q->vals.push_back(hv);
-                    q->nodes.push_back(rn);
-                    return 0;
-                }
-                // 2、p父节点的左兄弟富裕
-                else if (lb > -1 && (int)r->nodes[lb]->vals.size() > min_num) { // 摘下左兄弟一个节点，处理完毕
-                    // cout << "左叔叔富裕" << endl;
-                    // 从左兄弟处取走最后一个值
-                    auto lv = r->nodes[lb]->vals.back();
-                    r->nodes[lb]->vals.pop_back();
-                    auto ln = r->nodes[lb]->nodes.back();
-                    r->nodes[lb]->nodes.pop_back();
-                    // 将来自左兄弟的值交给父节点
-                    auto hv = r->vals[lb];
-                    r->vals[lb] = lv;
-                    // 插入来自父节点的值，接入来自左兄弟的节点
-                    auto &q = r->nodes[pos];
-                    q->vals.insert(q->vals.begin(), hv);
-                    q->nodes.insert(q->nodes.begin(), ln);
-                    return 0;
-                }
-                // 3、p父节点的父亲富裕或不富裕（若导致节点缺少，直接抛给上级节点处理）
-                else { // 摘下父亲一个节点，若原来父亲富裕则处理完毕，否则抛给上级处理
-                    // cout << "祖父富裕" << endl;
-                    // 合并
-                    if (rb > -1) { // 向右合并
-                        auto hv = r->vals[pos];
-                        auto lp = r->nodes[pos];
-                        auto rp = r->nodes[rb];
-                        lp->vals.push_back(hv);
-                        for (auto i : rp->vals) {
-                            lp->vals.push_back(i);
-                        }
-                        for (auto i : rp->nodes) {
-                            lp->nodes.push_back(i);
-                        }
-                        r->vals.erase(r->vals.begin() + pos);
-                        r->nodes.erase(r->nodes.begin() + rb);
-                        delete rp;
-                        rp = nullptr;
-                    } else if (lb > -1) { // 向左合并
-                        auto hv = r->vals[lb];
-                        auto lp = r->nodes[lb];
-                        auto rp = r->nodes[pos];
-                        lp->vals.push_back(hv);
-                        for (auto i : rp->vals) {
-                            lp->vals.push_back(i);
-                        }
-                        for (auto i : rp->nodes) {
-                            lp->nodes.push_back(i);
-                        }
-                        r->vals.erase(r->vals.begin() + lb);
-                        r->nodes.erase(r->nodes.begin() + pos);
-                        delete rp;
-                        rp = nullptr;
-                    }
-                    if (r == root && r->vals.size() == 0) { // 若树只有两层且根节点原本只有1个关键字，处理后根节点会没有值，直接减掉一层
-                        auto _r = r;
-                        r = r->nodes.front();
-                        delete _r;
-                        _r = nullptr;
-                        return 0;
-                    }
-                    if ((int)r->vals.size() > min_num) {
-                        return 0;
-                    } else {
-                        return 1;
-                    }
-                }
-            }
+    }
+    /**
+    * @brief   按占用字节数选择分裂位置，使两侧大致相等
+    * @param   es  节点中全部关键字（含新插入的）
+    * @param   lo  分裂位置下限
+    * @param   hi  分裂位置上限
+    * @return  int
+    */
+    static int splitPoint(const vector<node_value_t> &es, int lo, int hi) {
+        size_t total = 0, acc = 0;
+        for (auto &e : es) {
+            total += node::entrySize(e.first);
+        }
+        int i = 0;
+        while (i < (int)es.size() && acc * 2 < total) {
+            acc += node::entrySize(es[i++].first);
         }
-        return 1;
+        return clamp(i, lo, hi);
     }
 
     /**
-    * @brief   递归查找
-    * @param   r           节点
-    * @param   v           关键字
-    * @param   oper        > : 0; < : 1; = : 2; >= : 3; <= : 4;
-    * @return  node_ptr*   含关键字的节点
+    * @brief   关键字在Bloom过滤器中的字节
     */
-    node_ptr *_find(node_ptr &r, key_type v, const char oper = 2) {
-        if (r == nullptr) {
-            return nullptr;
-        }
-        auto n = r->vals.size();
-        if (r->isLeaf) {
-            if (oper == 2) { // =
-                for (auto i = 0uz; i < n; ++i) {
-                    if (v == r->vals[i].first) { // 已找到
-                        return &r;
-                    }
-                }
-            } else if (oper == 0) { // >
-                return &r;
-            } else if (oper == 1) { // <
-                return &r;
-            } else if (oper == 3) { // >=
-                return &r;
-            } else if (oper == 4) { // <=
-                return &r;
-            }
+    static string_view keyBytes(const key_type &k) {
+        if constexpr (keyTypeIsString<key_type>) {
+            return k;
+        } else {
+            return string_view((const char *)&k, sizeof(k));
         }
-        for (auto i = 0uz; i <= n; ++i) {
-            if (i == 0) { // 进入第一个子节点
-                if (v < r->vals.front().first) {
-                    return _find(r->nodes.front(), v, oper);
-                }
-            } else if (i == n) { // 进入最后一个子节点
-                if (v >= r->vals.back().first) {
-                    return _find(r->nodes.back(), v, oper);
-                }
-            } else { // 进入中间节点
-                if (v >= r->vals[i - 1].first && v < r->vals[i].first) {
-                    return _find(r->nodes[i], v, oper);
-                }
-            }
+    }
+    /**
+    * @brief   以两倍于现有关键字数的容量重建Bloom过滤器
+    */
+    void rebuildBloom() {
+        vector<key_type> ks;
+        walk(meta.head, 0, [&](key_ref k, int) {
+            ks.push_back(key_type(k));
+            return true;
+        });
+        bloom.reset(ks.size() * 2);
+        for (auto &k : ks) {
+            bloom.add(keyBytes(k));
         }
-        // 未找到
-        return nullptr;
     }
-
     /**
-    * @brief   层序遍历并打印
-    * @param   r   节点
+    * @brief   关键字是否可能存在，未开启Bloom过滤器时总为true
     */
-    void levelOrder(node_ptr r, printType t = KEY) {
-        vector<vector<node_ptr>> res;
-        _levelOrder(r, res);
-        for (auto i : res) {
-            for (auto j : i) {
-                for (auto k : j->vals) {
-                    if (t == KEY)
-                        cout << k.first << " ";
-                    else if (t == DINDEX)
-                        cout << k.second << " ";
-                    else if (t == ROOT)
-                        cout << j->isLeaf << " ";
-                    else if (t == INDEX)
-                        cout << j->index << " ";
-                }
-                cout << "\b; ";
-            }
-            cout << endl;
+    bool mayContain(const key_type &k) {
+        if (!filtered) {
+            return true;
+        }
+        if (!bloom.valid()) {
+            rebuildBloom();
         }
+        return bloom.mayContain(keyBytes(k));
     }
-
-    void levelOrder(bpTree::node_ptr r, string &o) {
-        if (r == nullptr) {
-            o = "";
+    /**
+    * @brief   将新插入的关键字加入Bloom过滤器，过滤器无效或已满时重建
+    */
+    void remember(const key_type &k) {
+        if (!filtered) {
             return;
         }
-        bool _leaf = false;
-        if (r->isLeaf) { // 只有一层节点
-            o += "$ ";
-            for (auto i : r->vals) {
-                o += (toStr(i.first)() + ",");
-            }
-            o.back() = ' ';
+        if (bloom.valid() && !bloom.full()) {
+            bloom.add(keyBytes(k));
+        } else {
+            rebuildBloom();
+        }
+    }
 
+    /**
+    * @brief   插入不存在的关键字，叶子节点已满时分裂
+    * @param   k
+    * @param   rid
+    */
+    void put(const key_type &k, int rid) {
+        if (getKeySize(k)() > (int)node::maxKeySize) {
+            cout << "Key too long!" << endl;
             return;
         }
-        queue<bpTree::node_ptr> q;
-        q.push(r);
-        q.push(nullptr);
-        while (!q.empty()) {
-            auto p = q.front();
-            q.pop();
-            if (p == nullptr) {
-                auto t = q.front();
-                if (!_leaf) {
-                    if (t->isLeaf) {
-                        o += "$ ";
-                        _leaf = true;
-                    } else {
-                        o += "# ";
-                    }
-                } else
-                    o += "# ";
-                if (!q.empty()) {
-                    q.push(nullptr);
-                }
-                continue;
-            }
-            for (auto i : p->vals)
-                o += (toStr(i.first)() + ",");
-            o.back() = ' ';
-            if (!p->isLeaf) {
-                for (auto i : p->nodes) {
-                    q.push(i);
-                }
-            }
+        vector<pair<int, int>> path;
+        int leafNo = descend(k, &path);
+        pinned p(filename, leafNo);
+        int i = p->lowerBound(k);
+        p.dirty = true;
+        if (p->fits(k)) {
+            p->insert(i, k, rid);
+            return;
+        }
+        bool append = i == p->count() && p->next() == -1;
+        auto es = entries(p.n);
+        es.emplace(es.begin() + i, k, rid);
+        int half = append ? es.size() - 1 : splitPoint(es, 1, es.size() - 1);
+        int rightNo = allocPage(true);
+        pinned r(filename, rightNo);
+        r.dirty = true;
+        refill(p.n, es, 0, half);
+        refill(r.n, es, half, es.size());
+        r->setNext(p->next());
+        r->setPrev(leafNo);
+        p->setNext(rightNo);
+        if (r->next() != -1) {
+            pinned q(filename, r->next());
+            q->setPrev(rightNo);
+            q.dirty = true;
+        } else {
+            meta.tail = rightNo;
         }
+        insertSeparator(path, node::separator(es[half - 1].first, es[half].first), rightNo, append);
+        storeMeta();
     }
 
-    void rebuild(bpTree::node_ptr &r, const vector<string> &_input) {
-        if (_input.size() == 1 && _input[0] == "") {
-            return;
-        }
-        size_t pos = 0uz;
-        bool _leaf = false;
-        bool _beg = true;
-        queue<bpTree::node_ptr *> q;
-        q.push(&r);
-        while (!q.empty()) {
-            if (pos + 1 > _input.size())
-                break;
-            if (_input[pos] == "#") {
-                ++pos;
-                continue;
-            }
-            if (_input[pos] == "$") {
-                _leaf = true;
-                ++pos;
-                continue;
+    /**
+    * @brief   将分裂产生的右节点插入父节点，父节点已满时继续分裂，根节点分裂时树长高一层
+    * @param   path    自根向下的路径
+    * @param   sep     分隔关键字，不大于右节点的最小关键字且大于左节点的最大关键字
+    * @param   rightNo 右节点页号
+    * @param   append  是否为在最右侧追加
+    */
+    void insertSeparator(vector<pair<int, int>> &path, key_type sep, int rightNo, bool append) {
+        while (!path.empty()) {
+            auto [pageNo, i] = path.back();
+            path.pop_back();
+            pinned p(filename, pageNo);
+            p.dirty = true;
+            if (p->fits(sep)) {
+                p->insert(i, sep, rightNo);
+                return;
             }
-            auto p = q.front();
-            q.pop();
-            (*p) = new bpTree::node;
-            if (_leaf) {
-                (*p)->isLeaf = true;
-                if (_beg) { // 初始状态
-                    head->leaf = &(*(*p));
-                    _beg = false;
-                } else {
-                    leafs.push_back(new leaf(*p));
-                }
-                if (leafs.size() == 3) {
-                    leafs.back()->next = tail;
-                    head->next = leafs.back();
-                } else if (leafs.size() > 3) {
-                    leafs.back()->next = tail;
-                    leafs[leafs.size() - 2]->next = leafs.back();
-                }
+            // 中间关键字上移，其右侧子节点成为新节点的最左子节点
+            append = append && i == p->count();
+            auto es = entries(p.n);
+            es.emplace(es.begin() + i, sep, rightNo);
+            int mid = append ? es.size() - 2 : splitPoint(es, 1, es.size() - 2);
+            int newNo = allocPage(false);
+            pinned r(filename, newNo);
+            r.dirty = true;
+            r->header()->first = es[mid].second;
+            refill(p.n, es, 0, mid);
+            refill(r.n, es, mid + 1, es.size());
+            sep = es[mid].first;
+            rightNo = newNo;
+        }
+        int rootNo = allocPage(false);
+        pinned r(filename, rootNo);
+        r.dirty = true;
+        r->header()->first = meta.root;
+        r->insert(0, sep, rightNo);
+        meta.root = rootNo;
+        meta.height++;
+    }
+
+    /**
+    * @brief   删除关键字，叶子节点为空时摘除
+    * @param   k
+    * @return  true    已删除
+    * @return  false   不存在
+    */
+    bool eraseKey(const key_type &k) {
+        vector<pair<int, int>> path;
+        int leafNo = descend(k, &path);
+        {
+            pinned p(filename, leafNo);
+            int i = p->lowerBound(k);
+            if (i == p->count() || !p->equals(i, k)) {
+                return false;
             }
-            vector<string> _vals;
-            str_split(_input[pos], _vals, ',');
-            for (auto _i : _vals) {
-                (*p)->vals.push_back(bpTree::node_value_t(keyFormatConverter<key_type>(_i)(), -1));
-                (*p)->nodes.push_back(nullptr);
+            p->erase(i);
+            p.dirty = true;
+            if (p->count() > 0 || leafNo == meta.root) {
+                return true;
             }
-            for (auto &_i : (*p)->nodes) {
-                q.push(&_i);
+            if (p->prev() != -1) {
+                pinned q(filename, p->prev());
+                q->setNext(p->next());
+                q.dirty = true;
+            } else {
+                meta.head = p->next();
             }
-            ++pos;
-        }
-        int _cnt = 0;
-        for (auto itr = head; itr != tail; itr = itr->next) {
-            itr->leaf->index = _cnt++;
-            if (_cnt == 1) {
-                ++_cnt;
+            if (p->next() != -1) {
+                pinned q(filename, p->next());
+                q->setPrev(p->prev());
+                q.dirty = true;
+            } else {
+                meta.tail = p->prev();
             }
         }
+        freePage(leafNo);
+        removeChild(path);
+        storeMeta();
+        return true;
     }
 
     /**
-    * @brief   递归删除r内的所有节点
-    * @param   r   节点
+    * @brief   从父节点中删除已释放的子节点，父节点因此没有子节点时一并释放
+    * @param   path    自根向下的路径
     */
-    void _clear(node_ptr r) {
-        if (r == nullptr) {
-            return;
+    void removeChild(vector<pair<int, int>> &path) {
+        while (!path.empty()) {
+            auto [pageNo, i] = path.back();
+            path.pop_back();
+            {
+                pinned p(filename, pageNo);
+                if (p->count() > 0) {
+                    if (i == 0) {
+                        p->header()->first = p->val(0);
+                    }
+                    p->erase(i == 0 ? 0 : i - 1);
+                    p.dirty = true;
+                    break;
+                }
+            }
+            freePage(pageNo);
         }
-        for (auto i : r->nodes) {
-            _clear(i);
+        while (meta.height > 1) {
+            int rootNo = meta.root;
+            {
+                pinned r(filename, rootNo);
+                if (r->count() > 0) {
+                    break;
+                }
+                meta.root = r->header()->first;
+            }
+            meta.height--;
+            freePage(rootNo);
         }
-        delete r;
-        r = nullptr;
     }
 
 public:
     /**
-    * @brief   创建新树
-    * @param   v   键值对数组
-    * @param   m   树阶数
+    * @brief   设置主键在行中的属性下标，设置后.ind缺失或无法识别时由.dat重建
+    * @param   k       属性下标，多于一个时为组合主键，关键字为各属性的保序编码
+    * @param   isInt   各属性是否为int
     */
-    void clear_all(int m = 3) {
-        clear();
-        root = nullptr;
-        head = new leaf;
-        tail = new leaf;
-        head->next = tail;
-        leafs.push_back(head);
-        leafs.push_back(tail);
-        // 计算每个节点的最少与最多关键字数
-        this->m = m;
-        min_num = (m + 1) / 2 - 1;
-        max_num = m;
+    void setKeyColumns(const vector<int> &k, const vector<bool> &isInt) {
+        keyColumns = keyCodec {k, isInt};
     }
-    void clear_all(vector<keyValue> &v, int m = 3) {
-        clear_all(m);
-        for (auto i : v) { // 依次插入
-            insert(i);
+
+    /**
+    * @brief   是否使用主键的Bloom过滤器
+    * @param   on
+    */
+    void setBloom(bool on) {
+        filtered = on;
+    }
+
+    /**
+    * @brief   行的主键
+    * @param   row
+    * @return  key_type
+    */
+    key_type rowKey(const rowView &row) {
+        if constexpr (keyTypeIsString<key_type>) {
+            if (keyColumns.columns.size() > 1) {
+                vector<string> vs;
+                for (auto i : keyColumns.columns) {
+                    vs.push_back(dm.getColumn(row, i));
+                }
+                return keyColumns.encode(vs);
+            }
         }
+        return keyFormatConverter<key_type>(dm.getColumn(row, keyColumns.columns[0]))();
     }
-    void init(string database, string table, int m = 3) {
-        root = nullptr;
-        min_num = (m + 1) / 2 - 1;
-        max_num = m;
-        head = new leaf;
-        tail = new leaf;
-        head->next = tail;
-        leafs.push_back(head);
-        leafs.push_back(tail);
 
-        this->m = m;
+    /**
+    * @brief   读取元数据页，判断索引文件能否识别，不重建
+    * @return  true
+    * @return  false   文件不存在、无法识别或版本不符
+    */
+    bool valid() {
+        char *p = pool().fetch(filename, 0);
+        memcpy(&meta, p, sizeof(meta));
+        pool().unpin(filename, 0);
+        int pages = pool().pageCount(filename);
+        return meta.magic == indMagic && meta.version == indVersion && meta.keyKind == keyTypeIsString<key_type> &&
+               meta.pageSize == maxPageSize && meta.root > 0 && meta.root < pages && meta.head > 0 &&
+               meta.head < pages && meta.tail > 0 && meta.tail < pages;
+    }
+
+    void init(string database, string table) {
         this->database = database;
         this->table = table;
+        this->filename = dataPos + database + "/" + table + ".ind";
+        bloom.init(dataPos + database + "/" + table + ".bloom");
+        recoverVacuum();
 
         dm.setKeyType(keyTypeIsString<key_type>);
         dm.init(database, table);
+    }
 
-        string _ser = "";
-        string _indexs = "";
-
-        string filename = dataPos + database + "/" + table + ".ind";
-        if (filesystem::exists(filename)) {
-            ifstream file(filename, ios::binary | ios::in);
-            getline(file, _ser);
-            if (_ser[0] == '!') {
-                file.close();
-                return;
-            }
-            getline(file, _indexs);
-            deSerialize(_ser);
-            for (auto i : _indexs) {
-                indexs.push_back((i == 0 ? false : true));
-            }
-            for (auto it = head; it != tail; it = it->next) {
-                for (auto &i : it->leaf->vals) {
-                    int sz = 0;
-                    file.read((char *)&sz, 4);
-                    if (keyTypeIsString<key_type>) {
-                        char iFirst[sz - 3];
-                        iFirst[sz - 4] = '\0';
-                        file.read(iFirst, sz - 4);
-                        string ifst(iFirst);
-                        setIVal(i.first, ifst);
-                    } else {
-                        int iFirst = 0;
-                        file.read((char *)&iFirst, 4);
-                        i.first = iFirst;
-                    }
-                    int iSecond = 0;
-                    file.read((char *)&iSecond, 4);
-                    setIVal(i.second, iSecond);
-                }
+    /**
+    * @brief   处理中断的vacuum：.dat.vac尚在时未提交，丢弃全部新文件；否则.dat已换入，换入.ind.vac
+    */
+    void recoverVacuum() {
+        string dat = dataPos + database + "/" + table + ".dat", vac = filename + ".vac";
+        if (filesystem::exists(dat + ".vac")) {
+            remove((dat + ".vac").c_str());
+            remove((dataPos + database + "/" + table + ".fsm.vac").c_str());
+            remove(vac.c_str());
+        } else if (filesystem::exists(vac)) {
+            pool().discard(filename);
+            pool().discard(vac);
+            if (rename(vac.c_str(), filename.c_str()) != 0) {
+                remove(filename.c_str());
             }
-            file.close();
-        } else {
-            return;
         }
     }
 
+    /**
+    * @brief   树高，只有根叶子节点时为1
+    * @return  int
+    */
+    int height() {
+        loadMeta();
+        return meta.height;
+    }
+
+    /**
+    * @brief   树是否为空
+    * @return  true
+    * @return  false
+    */
+    bool empty() {
+        loadMeta();
+        pinned r(filename, meta.root);
+        return r->isLeaf() && r->count() == 0;
+    }
+
     /**
     * @brief   插入节点
     * @param   v   键值对
+    * @return  int 记录的rid，主键过长或数据与表结构不符时为-1
     */
-    void insert(keyValue v) {
-        indexs.push_back(true);
-        node_value_t _v(v.key, indexs.size() - 1);
+    int insert(keyValue v) {
+        if (getKeySize(v.key)() > (int)node::maxKeySize) {
+            cout << "Primary key too long!" << endl;
+            return -1;
+        }
+        loadMeta();
         int _pos = -1;
-        insert(_v, _pos);
-        if (_pos >= 0) {
-            dm.updateRecord(_pos, v.data);
-            indexs[_pos] = true;
-            indexs.pop_back();
-        } else {
-            dm.createRecord(v.data);
+        if (lookup(v.key, _pos)) { // 相同key，直接替换值
+            return dm.updateRecord(_pos, v.data) ? _pos : -1;
+        }
+        _pos = dm.createRecord(v.data);
+        if (_pos < 0) {
+            return -1;
         }
+        put(v.key, _pos);
+        remember(v.key);
+        return _pos;
     }
 
     /**
-    * @brief   删除节点
-    * @param   v   键值对
+    * @brief   插入索引项，关键字已存在或过长时不变，不读写数据文件（供二级索引使用）
+    * @param   k
+    * @param   rid
     */
-    bool erase(key_type v) {
-        for (auto iter = head; iter != tail; iter = iter->next) {
-            for (auto i : iter->leaf->vals) {
-                if (i.first == v) {
-                    dm.deleteRecord(i.second);
-                }
-            }
+    void insertEntry(const key_type &k, int rid) {
+        if (getKeySize(k)() > (int)node::maxKeySize) {
+            cout << "Index key too long!" << endl;
+            return;
         }
-        if (root->isLeaf) { // 节点只有根节点
-            int n = root->vals.size();
-            for (auto i = 0; i < n; ++i) {
-                if (root->vals[i].first == v) { // 直接删除
-                    indexs[root->vals[i].second] = false;
-                    root->vals.erase(root->vals.begin() + i);
-                    root->nodes.pop_back();
-                    return true;
-                }
+        loadMeta();
+        int _pos = -1;
+        if (!lookup(k, _pos)) {
+            put(k, rid);
+        }
+    }
+    /**
+    * @brief   删除索引项，不读写数据文件
+    * @param   k
+    */
+    void eraseEntry(const key_type &k) {
+        loadMeta();
+        eraseKey(k);
+    }
+    /**
+    * @brief   以给定的索引项批量重建，不读写数据文件，过长的关键字跳过
+    * @param   es
+    */
+    void buildEntries(vector<node_value_t> &es) {
+        erase_if(es, [](auto &e) {
+            if (getKeySize(e.first)() > (int)node::maxKeySize) {
+                cout << "Index key too long!" << endl;
+                return true;
             }
             return false;
+        });
+        build(es);
+    }
+    /**
+    * @brief   自首个不小于k的关键字起按顺序遍历索引项，f返回false时停止
+    * @param   k
+    * @param   f   bool(key_ref, int)
+    */
+    template <typename F>
+    void scanEntries(const key_type &k, F f) {
+        loadMeta();
+        int leafNo = descend(k), i = 0;
+        {
+            pinned p(filename, leafNo);
+            i = p->lowerBound(k);
         }
-        // 递归删除
-        bool _found = false, _first = false;
-        _erase(root, v, _found, _first);
-        //traverse();
-        _first = true;
-        _erase(root, v, _found, _first);
-        if (!_found) {
+        walk(leafNo, i, f);
+    }
+
+    /**
+    * @brief   删除节点
+    * @param   v   键值对
+    */
+    bool erase(key_type v) {
+        loadMeta();
+        int _pos = -1;
+        if (!lookup(v, _pos)) {
             return false;
         }
-        return true;
+        dm.deleteRecord(_pos);
+        return eraseKey(v);
     }
     bool erase(vector<key_type> &key, vector<int> &poses, vector<bool> &erased) {
+        loadMeta();
         for (auto i = 0uz; i < key.size(); ++i) {
             if (poses[i] == -1 || erased[i] == false) {
                 continue;
             }
-            if (root->isLeaf) { // 节点只有根节点
-                int n = root->vals.size();
-                for (auto i = 0; i < n; ++i) {
-                    if (root->vals[i].first == key[i]) { // 直接删除
-                        indexs[root->vals[i].second] = false;
-                        root->vals.erase(root->vals.begin() + i);
-                        root->nodes.pop_back();
-                        continue;
-                    }
-                }
-                continue;
-            }
-            // 递归删除
-            bool _found = false, _first = false;
-            _erase(root, key[i], _found, _first);
-            //traverse();
-            _first = true;
-            _erase(root, key[i], _found, _first);
+            eraseKey(key[i]);
         }
         dm.deleteRecord(poses, erased);
         return true;
     }
 
-
-    /**
-    * @brief   查找键值对所在节点
-    * @param   v           key
-    * @return  node_ptr*   节点
-    */
-    node_ptr *getNode(key_type v, const char oper = 2) {
-        return _find(root, v, oper);
-    }
-
     /**
     * @brief    更改关键字值
     * @param    key       // 键值对
     * @param    data    // data
     */
     bool update(key_type key, data_type data) {
-        for (auto itr = head; itr != tail; itr = itr->next) {
-            for (auto i : itr->leaf->vals) {
-                if (i.first == key) {
-                    dm.updateRecord(i.second, data);
-                    return true;
-                }
-            }
+        loadMeta();
+        int _pos = -1;
+        if (!lookup(key, _pos)) {
+            return false;
         }
-
-        return false;
+        return dm.updateRecord(_pos, data);
     }
     bool update_some(vector<data_type> &data, vector<int> &poses) {
         dm.updateRecord(poses, data);
         return true;
     }
 
+    /**
+    * @brief   update修改主键时，以新关键字替换原关键字，rid不变，不读写数据文件
+    * @param   olds    原关键字
+    * @param   news    新关键字，与olds一一对应
+    * @param   poses   rid
+    * @return  true    成功
+    * @return  false   新关键字过长、彼此重复或已被其他行占用，未作修改
+    */
+    bool rekey(const vector<key_type> &olds, const vector<key_type> &news, const vector<int> &poses) {
+        loadMeta();
+        vector<key_type> _olds = olds, _news = news;
+        sort(_olds.begin(), _olds.end());
+        sort(_news.begin(), _news.end());
+        if (adjacent_find(_news.begin(), _news.end()) != _news.end()) {
+            cout << "Primary key already exists!" << endl;
+            return false;
+        }
+        for (auto &k : _news) {
+            if (getKeySize(k)() > (int)node::maxKeySize) {
+                cout << "Primary key too long!" << endl;
+                return false;
+            }
+            int _pos = -1;
+            if (!binary_search(_olds.begin(), _olds.end(), k) && lookup(k, _pos)) {
+                cout << "Primary key already exists!" << endl;
+                return false;
+            }
+        }
+        for (auto &k : olds) {
+            eraseKey(k);
+        }
+        for (auto i = 0uz; i < news.size(); ++i) {
+            put(news[i], poses[i]);
+            remember(news[i]);
+        }
+        return true;
+    }
+
+    /**
+    * @brief    按主键顺序重写数据文件，再以新rid批量重建索引
+    *           新数据文件及新索引先分别写入.dat.vac及.ind.vac，依次换入.dat、.ind；
+    *           换入.dat为提交点，之前中断时丢弃新文件，之后中断时由recoverVacuum换入.ind
+    * @return   true    成功
+    * @return   false   失败，数据文件及索引不变
+    */
+    bool vacuum() {
+        loadMeta();
+        vector<node_value_t> es;
+        vector<int> poses;
+        walk(meta.head, 0, [&](key_ref k, int rid) {
+            es.emplace_back(key_type(k), rid);
+            poses.push_back(rid);
+            return true;
+        });
+        if (!dm.vacuum(poses)) {
+            return false;
+        }
+        auto n = 0uz;
+        for (auto i = 0uz; i < es.size(); ++i) {
+            if (poses[i] != -1) {
+                es[n++] = {std::move(es[i].first), poses[i]};
+            }
+        }
+        es.resize(n);
+        string ind = filename, vac = filename + ".vac";
+        filename = vac;
+        pool().discard(vac);
+        remove(vac.c_str());
+        build(es);
+        bool ok = pool().flush(vac);
+        filename = ind;
+        pool().discard(vac);
+        if (!ok || !dm.commitVacuum()) {
+            dm.abortVacuum();
+            remove(vac.c_str());
+            return false;
+        }
+        pool().discard(ind);
+        if (rename(vac.c_str(), ind.c_str()) != 0) { // 旧索引与新数据文件不符，删除后由数据文件重建
+            remove(ind.c_str());
+        }
+        return true;
+    }
+
+    /**
+    * @brief    批量导入，已存在的关键字替换其值，导入后批量重建索引
+    * @param    vs      键值对，关键字相同时保留最后一个
+    * @param    fill    节点填充率
+    */
+    void load(vector<keyValue> &vs, double fill = bulkFill) {
+        loadMeta();
+        stable_sort(vs.begin(), vs.end(), [](auto &a, auto &b) { return a.key < b.key; });
+        vector<node_value_t> es;
+        walk(meta.head, 0, [&es](key_ref k, int rid) {
+            es.emplace_back(key_type(k), rid);
+            return true;
+        });
+        vector<key_type> keys;
+        vector<string> rows;
+        auto j = 0uz;
+        for (auto i = 0uz; i < vs.size(); ++i) {
+            if (i + 1 < vs.size() && !(vs[i].key < vs[i + 1].key)) {
+                continue;
+            }
+            if (getKeySize(vs[i].key)() > (int)node::maxKeySize) {
+                cout << "Primary key too long!" << endl;
+                continue;
+            }
+            while (j < es.size() && es[j].first < vs[i].key) {
+                ++j;
+            }
+            if (j < es.size() && es[j].first == vs[i].key) {
+                dm.updateRecord(es[j].second, vs[i].data);
+                continue;
+            }
+            keys.push_back(vs[i].key);
+            rows.push_back(std::move(vs[i].data));
+        }
+        vector<int> rids;
+        dm.createRecord(rows, rids);
+        for (auto i = 0uz; i < keys.size(); ++i) {
+            if (rids[i] != -1) {
+                es.emplace_back(std::move(keys[i]), rids[i]);
+            }
+        }
+        build(es, fill);
+    }
+
     /**
     * @brief    查找
     * @param    key
@@ -1171,236 +949,161 @@ public:
     */
     string find(key_type key) {
         string res = "";
-        auto _n = getNode(key);
-        int pos = 0;
-        if (_n == nullptr) {
+        loadMeta();
+        int pos = -1;
+        if (!lookup(key, pos)) {
             return res;
         }
-        for (auto &i : (*_n)->vals) {
-            if (i.first == key) {
-                pos = i.second;
-            }
-        }
         dm.readRecord(res, pos);
         return res;
     }
-    void find_some(vector<key_type> &key, vector<string> &res, vector<int> &poses) {
-        auto sz = key.size();
-        for (auto i = 0uz; i < sz; ++i) {
-            auto _n = getNode(key[i]);
-            if (_n == nullptr) {
-                continue;
-            }
-            for (auto j = 0uz; j < (*_n)->vals.size(); ++j) {
-                if (((*_n)->vals)[j].first == key[i]) {
-                    poses[i] = ((*_n)->vals)[j].second;
-                    break;
-                }
-            }
+    /**
+    * @brief    批量查找
+    * @param    key     key
+    * @param    res     行数据
+    * @param    poses   rid
+    * @param    filter  列存表下推的属性裁剪与等值条件
+    */
+    void find_some(vector<key_type> &key, vector<string_view> &res, vector<int> &poses, const scanFilter &filter = {}) {
+        loadMeta();
+        for (auto i = 0uz; i < key.size(); ++i) {
+            lookup(key[i], poses[i]);
         }
-        dm.readRecord(res, poses);
+        dm.readRecord(res, poses, filter);
     }
-    void find_some(vector<key_type> &key, vector<string> &res) {
+    void find_some(vector<key_type> &key, vector<string_view> &res) {
         vector<int> poses(key.size(), -1);
         find_some(key, res, poses);
     }
-    void find_matched(key_type key, vector<key_type> &keys, vector<string> &res, vector<int> &poses, const char oper) {
-        auto _n = getNode(key, oper);
-        if (_n == nullptr) {
-            return;
-        }
-        // > : 0; < : 1; = : 2; >= : 3; <= 4;
-        leaf_ptr p;
+    /**
+    * @brief    按主键顺序读取全部记录
+    * @param    keys    输出，主键
+    * @param    res     输出，行数据
+    * @param    poses   输出，rid
+    * @param    filter  列存表下推的属性裁剪与等值条件
+    */
+    void find_all(vector<key_type> &keys, vector<string_view> &res, vector<int> &poses, const scanFilter &filter = {}) {
+        find_keys(keys, poses);
+        res.resize(keys.size());
+        dm.readRecord(res, poses, filter);
+    }
+    /**
+    * @brief    按主键上的条件只读取索引，不读写数据文件
+    * @param    key     比较值
+    * @param    keys    输出，主键
+    * @param    poses   输出，rid
+    * @param    oper    > : 0; < : 1; = : 2; >= : 3; <= 4;
+    */
+    void find_keys(key_type key, vector<key_type> &keys, vector<int> &poses, const char oper) {
+        loadMeta();
+        auto take = [&](key_ref k, int rid) {
+            keys.push_back(key_type(k));
+            poses.push_back(rid);
+            return true;
+        };
         switch (oper) {
         case 0: // >
-            p = leafs[(*_n)->index];
-            for (auto &i : (*_n)->vals) {
-                if (i.first > key) {
-                    keys.push_back(i.first);
-                    poses.push_back(i.second);
-                }
-            }
-            p = p->next;
-            while (p != tail) {
-                for (auto &i : p->leaf->vals) {
-                    keys.push_back(i.first);
-                    poses.push_back(i.second);
-                }
-                p = p->next;
+        case 3: { // >=
+            int leafNo = descend(key), i = 0;
+            {
+                pinned p(filename, leafNo);
+                i = oper == 0 ? p->upperBound(key) : p->lowerBound(key);
             }
+            walk(leafNo, i, take);
             break;
+        }
         case 1: // <
-            p = head;
-            while (p != tail) {
-                bool _br = false;
-                for (auto &i : p->leaf->vals) {
-                    if (i.first >= key) {
-                        _br = true;
-                        break;
-                    }
-                    keys.push_back(i.first);
-                    poses.push_back(i.second);
-                }
-                if (_br == true)
-                    break;
-                p = p->next;
-            }
-            break;
-        case 2: // =
-            for (auto &i : (*_n)->vals) {
-                if (i.first == key) {
-                    keys.push_back(i.first);
-                    poses.push_back(i.second);
-                    break;
-                }
-            }
-            break;
-        case 3: // >=
-            p = leafs[(*_n)->index];
-            for (auto &i : (*_n)->vals) {
-                if (i.first >= key) {
-                    keys.push_back(i.first);
-                    poses.push_back(i.second);
-                }
-            }
-            p = p->next;
-            while (p != tail) {
-                for (auto &i : p->leaf->vals) {
-                    keys.push_back(i.first);
-                    poses.push_back(i.second);
-                }
-                p = p->next;
-            }
-            break;
         case 4: // <=
-            p = head;
-            while (p != tail) {
-                bool _br = false;
-                for (auto &i : p->leaf->vals) {
-                    if (i.first > key) {
-                        _br = true;
-                        break;
-                    }
-                    keys.push_back(i.first);
-                    poses.push_back(i.second);
+            walk(meta.head, 0, [&](key_ref k, int rid) {
+                if (oper == 1 ? !(k < key) : key < k) {
+                    return false;
                 }
-                if (_br == true)
-                    break;
-                p = p->next;
+                return take(k, rid);
+            });
+            break;
+        case 2: { // =
+            int pos = -1;
+            if (lookup(key, pos)) {
+                keys.push_back(key);
+                poses.push_back(pos);
             }
             break;
         }
-        res.resize(keys.size(), "");
-        dm.readRecord(res, poses);
+        }
+    }
+    /**
+    * @brief    按主键顺序读取全部主键，不读写数据文件
+    * @param    keys    输出，主键
+    * @param    poses   输出，rid
+    */
+    void find_keys(vector<key_type> &keys, vector<int> &poses) {
+        loadMeta();
+        walk(meta.head, 0, [&](key_ref k, int rid) {
+            keys.push_back(key_type(k));
+            poses.push_back(rid);
+            return true;
+        });
+    }
+    void find_matched(key_type key, vector<key_type> &keys, vector<string_view> &res, vector<int> &poses, const char oper,
+                      const scanFilter &filter = {}) {
+        find_keys(key, keys, poses, oper);
+        res.resize(keys.size());
+        dm.readRecord(res, poses, filter);
     }
-    void find_matched(key_type key, vector<string> &res, vector<int> &poses, const char oper) {
+    void find_matched(key_type key, vector<string_view> &res, vector<int> &poses, const char oper,
+                      const scanFilter &filter = {}) {
         vector<key_type> keys;
-        find_matched(key, keys, res, poses, oper);
+        find_matched(key, keys, res, poses, oper, filter);
     }
-    void find_matched(key_type key, vector<string> &res, const char oper) {
+    void find_matched(key_type key, vector<string_view> &res, const char oper, const scanFilter &filter = {}) {
         vector<key_type> keys;
         vector<int> poses;
-        find_matched(key, keys, res, poses, oper);
+        find_matched(key, keys, res, poses, oper, filter);
     }
 
     /**
-    * @brief   层序遍历并打印每层结构
+    * @brief   按叶子节点打印关键字
     */
-    void traverse(printType t = KEY) {
-        cout << "-----------------------------" << endl;
-        levelOrder(root, t);
-        cout << "-----------------------------" << endl;
-    }
-
-    void print(printType t = KEY) {
-        for (auto iter = head; iter != tail; iter = iter->next) {
-            for (auto i : iter->leaf->vals) {
-                if (t == KEY)
-                    cout << i.first << " ";
+    void print() {
+        loadMeta();
+        for (int leafNo = meta.head; leafNo != -1;) {
+            pinned p(filename, leafNo);
+            for (auto i = 0; i < p->count(); ++i) {
+                cout << p->key(i) << " ";
             }
             cout << "; ";
+            leafNo = p->next();
         }
         cout << endl;
     }
 
     /**
-    * @brief   清空bTree
-    * @param   r
+    * @brief   释放对表的引用，索引页仍留在缓冲池中
     */
     void clear() {
-        leafs.clear();
-        auto p = head, q = p;
-        while (p != nullptr) {
-            q = p;
-            p = p->next;
-            delete q;
-            q = nullptr;
-        }
-        _clear(root);
-        indexs.clear();
         dm.renew();
     }
 
     /**
-    * @brief   b+树的序列化
-    * @return  string 以字符串形式表示及存储
+    * @brief   将索引的脏页写回磁盘
+    * @return  true    成功
+    * @return  false   写入失败，见bufferPool::flush
     */
-    string serialize() {
-        string output = "";
-        levelOrder(root, output);
-
-        return output;
-    }
-
-    /**
-    * @brief   以序列化的形式对树结构进行存储，同时记录每个节点的数据
-    */
-    void save() {
-        string filename = dataPos + database + "/" + table + ".ind";
-        ofstream file(filename, ios::binary | ios::out);
-        if (root == nullptr) {
-            string sss("!");
-            file.write(sss.c_str(), sss.size());
-            file.close();
-            return;
-        }
-        string _res = serialize();
-
-        file.write(_res.c_str(), _res.size());
-        file.write("\n", 1);
-        for (auto i : indexs) {
-            char t[1] = {};
-            t[0] = (i ? 1 : 0);
-            file.write(t, 1);
-        }
-        file.write("\n", 1);
-        for (auto itr = head; itr != tail; itr = itr->next) {
-            for (auto i : itr->leaf->vals) {
-                int sz = getKeySize(i.first)() + 4;
-                file.write((char *)&sz, 4);
-                file.write((getKeyData(i.first)()), sz - 4);
-                file.write((char *)&i.second, 4);
-            }
-        }
-        file.close();
-    }
-
-    /**
-    * @brief   反序列化
-    * @param   s   b+树序列化后的序列
-    */
-    void deSerialize(string &s) {
-        vector<string> _res;
-        str_split(s, _res, ' ');
-        clear_all(3);
-        rebuild(root, _res);
+    bool save() {
+        bool ok = pool().flush(filename);
+        return (!filtered || bloom.save()) && ok;
     }
 
     /**
     * @brief   无条件初始化该树在磁盘上的存储数据
     */
     void recordInit() {
+        if (!filesystem::exists(dataPos + database + "/" + table + ".dat")) {
+            pool().discard(filename);
+            remove(filename.c_str());
+            bloom.drop();
+        }
         dm.profInit();
     }
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,563 @@
+/**
+ * @file        bufferPool.h
+ * @brief       页缓冲池
+ *              以页为单位缓存数据文件，所有表共享同一个缓冲池
+ *              frame：
+ *                  页数据、所属文件、页号、pin计数、脏页标志、CLOCK引用位
+ *              淘汰：
+ *                  CLOCK算法，跳过被pin住的页，脏页在淘汰或flush时写回磁盘
+ *              写回：
+ *                  每个文件记录其变脏的帧，flush只处理这些帧，代价与缓冲池大小无关
+ *                  flush时将同一文件的脏页按页号排序，页号连续的脏页合并为一次pwritev
+ *                  部分写入时继续写入余下部分；写入失败的页保持为脏页，留待下次flush重试，flush返回false
+ *              读取失败时fetch抛出ioError，不以0填充冒充空页，避免之后写回覆盖磁盘上的数据
+ *              帧数据按缓存行（frameAlign字节）对齐，页内按缓存行对齐的数组在内存中同样对齐
+ *              预算：
+ *                  内存预算/页大小 = 帧数上限，全部帧被pin住时临时超出预算
+ *                  预算可由set pool在运行时调整，命中、缺页、淘汰等计数由show pool查看
+ * @author      hjb
+ * @version     1.0
+ * @date        2023-12-02
+ * @copyright   Copyright (c) 2023
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bpT {
+using namespace std;
+
+static const size_t frameAlign = 64;    // 帧数据的对齐字节数
+
+/**
+* @brief   页读取失败，由语句执行处捕获，语句中止
+*/
+struct ioError : runtime_error {
+    using runtime_error::runtime_error;
+};
+
+/**
+* @brief   页缓冲池
+*/
+class bufferPool {
+private:
+    /**
+    * @brief   释放按frameAlign对齐分配的帧数据
+    */
+    struct alignedDelete {
+        void operator()(char *p) const {
+            ::operator delete[](p, align_val_t(frameAlign));
+        }
+    };
+    /**
+    * @brief   缓冲帧
+    */
+    struct frame {
+        int file = -1;          // 所属文件编号
+        int pageNo = -1;        // 页号
+        int pinCount = 0;       // 使用者数目，大于0时不可淘汰
+        bool dirty = false;     // 脏页标志
+        bool ref = false;       // CLOCK引用位
+        unique_ptr<char[], alignedDelete> data;
+    };
+    /**
+    * @brief   已打开的文件
+    */
+    struct fileInfo {
+        string name = "";   // 文件路径
+        int fd = -1;        // 文件描述符
+        int pages = 0;      // 文件页数（含尚未写回的新页）
+        vector<size_t> dirty;   // 变脏的帧下标，可能含已写回或已被复用的帧
+    };
+
+    size_t pageSize;    // 页大小
+    size_t capacity;    // 帧数上限
+    size_t hand = 0;    // CLOCK指针
+    vector<frame> frames;
+    unordered_map<uint64_t, size_t> pageTable;  // (文件编号, 页号) -> 帧下标
+    vector<fileInfo> files;
+    unordered_map<string, int> fileIds;         // 文件路径 -> 文件编号
+
+    size_t hits = 0;        // 命中次数
+    size_t misses = 0;      // 缺页次数
+    size_t evictions = 0;   // 淘汰次数
+    size_t writes = 0;      // 写回页数
+    size_t writeCalls = 0;  // 写回的系统调用次数
+    size_t saved = 0;       // 合并写回节省的系统调用次数，按每个写回成功的区间的页数与实际调用次数之差累计
+    size_t bytes = 0;       // 写回字节数
+
+public:
+    bufferPool(size_t page_size, size_t budget) noexcept {
+        this->pageSize = page_size;
+        this->capacity = max(budget / page_size, (size_t)1);
+    }
+    ~bufferPool() noexcept {
+        flushAll();
+        for (auto &f : files) {
+            if (f.fd >= 0) {
+                close(f.fd);
+            }
+        }
+    }
+    bufferPool(const bufferPool &) = delete;
+    bufferPool &operator=(const bufferPool &) = delete;
+
+    /**
+    * @brief   获取文件的某一页并pin住，不存在的页以0填充
+    * @param   filename    文件路径
+    * @param   pageNo      页号
+    * @return  char*       页数据，大小为pageSize
+    * @throw   ioError     读取失败，不缓存该页
+    */
+    char *fetch(const string &filename, int pageNo) {
+        int file = openFile(filename);
+        auto itr = pageTable.find(pageKey(file, pageNo));
+        if (itr != pageTable.end()) {
+            auto &fr = frames[itr->second];
+            fr.pinCount++;
+            fr.ref = true;
+            hits++;
+            return fr.data.get();
+        }
+        misses++;
+        auto id = victim();
+        auto &fr = frames[id];
+        if (!readFully(file, fr.data.get(), (off_t)pageNo * pageSize)) {
+            throw ioError("Read failed: " + files[file].name + ": " + strerror(errno));
+        }
+        fr.file = file;
+        fr.pageNo = pageNo;
+        fr.pinCount = 1;
+        fr.dirty = false;
+        fr.ref = true;
+        pageTable[pageKey(file, pageNo)] = id;
+        return fr.data.get();
+    }
+
+    /**
+    * @brief   释放对某一页的使用
+    * @param   filename    文件路径
+    * @param   pageNo      页号
+    * @param   dirty       该页是否被修改
+    */
+    void unpin(const string &filename, int pageNo, bool dirty = false) {
+        auto fid = fileIds.find(filename);
+        if (fid == fileIds.end()) {
+            return;
+        }
+        auto itr = pageTable.find(pageKey(fid->second, pageNo));
+        if (itr == pageTable.end()) {
+            return;
+        }
+        auto &fr = frames[itr->second];
+        if (fr.pinCount > 0) {
+            fr.pinCount--;
+        }
+        if (dirty) {
+            auto &f = files[fid->second];
+            if (!fr.dirty) {
+                f.dirty.push_back(itr->second);
+            }
+            fr.dirty = true;
+            f.pages = max(f.pages, pageNo + 1);
+        }
+    }
+
+    /**
+    * @brief   文件页数
+    * @param   filename    文件路径
+    * @return  int         页数
+    */
+    int pageCount(const string &filename) {
+        return files[openFile(filename)].pages;
+    }
+
+    /**
+    * @brief   将文件的脏页写回磁盘
+    * @param   filename    文件路径
+    * @return  true        成功
+    * @return  false       写入失败，未写回的页仍为脏页
+    */
+    bool flush(const string &filename) {
+        auto fid = fileIds.find(filename);
+        if (fid == fileIds.end()) {
+            return true;
+        }
+        auto &f = files[fid->second];
+        vector<size_t> ids;
+        for (auto i : f.dirty) {
+            if (i < frames.size() && frames[i].file == fid->second && frames[i].dirty) {
+                ids.push_back(i);
+            }
+        }
+        f.dirty.clear();
+        sort(ids.begin(), ids.end());
+        ids.erase(unique(ids.begin(), ids.end()), ids.end());
+        return writeRuns(ids);
+    }
+    bool flushAll() {
+        vector<vector<size_t>> ids(files.size());
+        for (auto i = 0uz; i < frames.size(); ++i) {
+            if (frames[i].file >= 0 && frames[i].dirty) {
+                ids[frames[i].file].push_back(i);
+            }
+        }
+        for (auto &f : files) {
+            f.dirty.clear();
+        }
+        bool ok = true;
+        for (auto &i : ids) {
+            ok = writeRuns(i) && ok;
+        }
+        return ok;
+    }
+
+    /**
+    * @brief   丢弃文件在缓冲池中的所有页并关闭文件，用于文件删除前
+    * @param   filename    文件路径
+    */
+    void discard(const string &filename) {
+        auto fid = fileIds.find(filename);
+        if (fid == fileIds.end()) {
+            return;
+        }
+        for (auto i = 0uz; i < frames.size(); ++i) {
+            auto &fr = frames[i];
+            if (fr.file == fid->second) {
+                pageTable.erase(pageKey(fr.file, fr.pageNo));
+                fr.file = -1;
+                fr.pageNo = -1;
+                fr.pinCount = 0;
+                fr.dirty = false;
+                fr.ref = false;
+            }
+        }
+        auto &f = files[fid->second];
+        if (f.fd >= 0) {
+            close(f.fd);
+        }
+        f.fd = -1;
+        f.pages = 0;
+        f.name = "";
+        f.dirty.clear();
+        fileIds.erase(fid);
+    }
+
+    /**
+    * @brief   将文件截断为pages页，丢弃被截去的页
+    * @param   filename    文件路径
+    * @param   pages       截断后的页数
+    */
+    void truncate(const string &filename, int pages) {
+        int file = openFile(filename);
+        for (auto &fr : frames) {
+            if (fr.file == file && fr.pageNo >= pages) {
+                pageTable.erase(pageKey(fr.file, fr.pageNo));
+                fr.file = -1;
+                fr.pageNo = -1;
+                fr.pinCount = 0;
+                fr.dirty = false;
+                fr.ref = false;
+            }
+        }
+        auto &f = files[file];
+        if (f.fd >= 0 && ftruncate(f.fd, (off_t)pages * pageSize) == 0) {
+            f.pages = pages;
+        }
+    }
+
+    /**
+    * @brief   丢弃某目录下所有文件的页，用于删除数据库前
+    * @param   dirname     目录路径
+    */
+    void discardDir(const string &dirname) {
+        vector<string> names;
+        for (auto &f : fileIds) {
+            if (f.first.compare(0, dirname.size(), dirname) == 0) {
+                names.push_back(f.first);
+            }
+        }
+        for (auto &i : names) {
+            discard(i);
+        }
+    }
+
+    /**
+    * @brief   调整内存预算，多出的帧在下次淘汰时回收
+    * @param   budget  字节数
+    */
+    void resize(size_t budget) {
+        capacity = max(budget / pageSize, (size_t)1);
+        while (frames.size() > capacity && frames.back().pinCount == 0) {
+            auto &fr = frames.back();
+            if (fr.file >= 0) {
+                if (fr.dirty && !writeBack(fr)) {
+                    break;
+                }
+                pageTable.erase(pageKey(fr.file, fr.pageNo));
+            }
+            frames.pop_back();
+        }
+        hand = 0;
+    }
+
+    /**
+    * @brief   内存预算
+    * @return  size_t  字节数
+    */
+    size_t budget() const {
+        return capacity * pageSize;
+    }
+    size_t hitCount() const {
+        return hits;
+    }
+    size_t missCount() const {
+        return misses;
+    }
+    size_t evictCount() const {
+        return evictions;
+    }
+    size_t writeCount() const {
+        return writes;
+    }
+    size_t bytesWritten() const {
+        return bytes;
+    }
+    /**
+    * @brief   合并写回相比逐页写回节省的系统调用次数
+    * @return  size_t
+    */
+    size_t syscallsSaved() const {
+        return saved;
+    }
+    size_t size() const {
+        return frames.size();
+    }
+
+private:
+    static uint64_t pageKey(int file, int pageNo) {
+        return ((uint64_t)(uint32_t)file << 32) | (uint32_t)pageNo;
+    }
+
+    /**
+    * @brief   打开文件并登记，已打开则直接返回编号
+    * @param   filename    文件路径
+    * @return  int         文件编号
+    */
+    int openFile(const string &filename) {
+        auto fid = fileIds.find(filename);
+        if (fid != fileIds.end()) {
+            return fid->second;
+        }
+        fileInfo f;
+        f.name = filename;
+        f.fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+        struct stat st;
+        if (f.fd >= 0 && fstat(f.fd, &st) == 0) {
+            f.pages = (st.st_size + pageSize - 1) / pageSize;
+        }
+        int id = -1;
+        for (auto i = 0uz; i < files.size(); ++i) {
+            if (files[i].fd < 0 && files[i].name == "") {
+                id = i;
+                break;
+            }
+        }
+        if (id == -1) {
+            id = files.size();
+            files.push_back(f);
+        } else {
+            files[id] = f;
+        }
+        fileIds[filename] = id;
+        return id;
+    }
+
+    /**
+    * @brief   CLOCK算法选出一个空闲帧
+    * @return  size_t  帧下标
+    */
+    size_t victim() {
+        if (frames.size() < capacity) {
+            return newFrame();
+        }
+        for (auto n = 0uz; n < frames.size() * 2; ++n) {
+            hand = (hand + 1) % frames.size();
+            auto &fr = frames[hand];
+            if (fr.file < 0) {
+                return hand;
+            }
+            if (fr.pinCount > 0) {
+                continue;
+            }
+            if (fr.ref) {
+                fr.ref = false;
+                continue;
+            }
+            if (fr.dirty && !writeBack(fr)) {
+                continue;
+            }
+            pageTable.erase(pageKey(fr.file, fr.pageNo));
+            fr.file = -1;
+            evictions++;
+            return hand;
+        }
+        // 所有帧均被pin住，临时扩充
+        return newFrame();
+    }
+
+    /**
+    * @brief   新增一个对齐的帧
+    * @return  size_t  帧下标
+    */
+    size_t newFrame() {
+        frames.push_back(frame{});
+        frames.back().data.reset(new (align_val_t(frameAlign)) char[pageSize]);
+        return frames.size() - 1;
+    }
+
+    /**
+    * @brief   自off起读入一页，被信号中断时重试，文件末尾之后的部分以0填充
+    * @param   file    文件编号
+    * @param   buf     缓冲区，大小为pageSize
+    * @param   off     文件偏移
+    * @return  true    成功
+    * @return  false   读取失败，errno为错误原因
+    */
+    bool readFully(int file, char *buf, off_t off) {
+        size_t got = 0;
+        while (got < pageSize) {
+            auto n = pread(files[file].fd, buf + got, pageSize - got, off + got);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                return false;
+            }
+            if (n == 0) {
+                break;
+            }
+            got += n;
+        }
+        memset(buf + got, 0, pageSize - got);
+        return true;
+    }
+
+    /**
+    * @brief   自off起写入一组缓冲区，部分写入时继续写入余下部分，被信号中断时重试
+    * @param   file    文件编号
+    * @param   iov     缓冲区，写入过程中被修改
+    * @param   off     文件偏移
+    * @return  true    全部写入
+    * @return  false   写入失败
+    */
+    bool writeFully(int file, vector<iovec> &iov, off_t off) {
+        auto &f = files[file];
+        if (f.fd < 0) {
+            cout << "Write back failed: " << f.name << " is not open" << endl;
+            return false;
+        }
+        for (auto i = 0uz; i < iov.size();) {
+            auto n = pwritev(f.fd, iov.data() + i, iov.size() - i, off);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                cout << "Write back failed: " << f.name << ": " << strerror(n < 0 ? errno : EIO) << endl;
+                return false;
+            }
+            writeCalls++;
+            off += n;
+            for (; i < iov.size() && (size_t)n >= iov[i].iov_len; ++i) {
+                n -= iov[i].iov_len;
+            }
+            if (i < iov.size()) {
+                iov[i].iov_base = (char *)iov[i].iov_base + n;
+                iov[i].iov_len -= n;
+            }
+        }
+        return true;
+    }
+
+    /**
+    * @brief   脏页写回，失败时仍为脏页
+    * @param   fr  帧
+    * @return  true    成功
+    * @return  false   失败
+    */
+    bool writeBack(frame &fr) {
+        vector<iovec> iov {iovec{fr.data.get(), pageSize}};
+        if (!writeFully(fr.file, iov, (off_t)fr.pageNo * pageSize)) {
+            return false;
+        }
+        writes++;
+        bytes += pageSize;
+        fr.dirty = false;
+        return true;
+    }
+
+    /**
+    * @brief   写回同一文件的一组脏页，页号连续的页合并为一次pwritev，写入失败的页仍为脏页
+    * @param   ids 帧下标
+    * @return  true    全部写回
+    * @return  false   有页写入失败
+    */
+    bool writeRuns(vector<size_t> &ids) {
+        if (ids.empty()) {
+            return true;
+        }
+        sort(ids.begin(), ids.end(), [this](size_t a, size_t b) {
+            return frames[a].pageNo < frames[b].pageNo;
+        });
+        int file = frames[ids[0]].file;
+        bool ok = true;
+        vector<iovec> iov;
+        for (auto beg = 0uz; beg < ids.size();) {
+            auto end = beg + 1;
+            while (end < ids.size() && end - beg < IOV_MAX &&
+                   frames[ids[end]].pageNo == frames[ids[end - 1]].pageNo + 1) {
+                end++;
+            }
+            iov.clear();
+            for (auto i = beg; i < end; ++i) {
+                iov.push_back(iovec{frames[ids[i]].data.get(), pageSize});
+            }
+            auto calls = writeCalls;
+            bool written = writeFully(file, iov, (off_t)frames[ids[beg]].pageNo * pageSize);
+            // 部分写入后继续写入的调用也计入，写入失败的区间不计
+            if (written && end - beg > writeCalls - calls) {
+                saved += end - beg - (writeCalls - calls);
+            }
+            if (written) {
+                for (auto i = beg; i < end; ++i) {
+                    frames[ids[i]].dirty = false;
+                }
+                writes += end - beg;
+                bytes += (end - beg) * pageSize;
+            } else {
+                // 留在脏页列表中，下次flush重试
+                files[file].dirty.insert(files[file].dirty.end(), ids.begin() + beg, ids.begin() + end);
+                ok = false;
+            }
+            beg = end;
+        }
+        return ok;
+    }
+};
+}
@@ -0,0 +1,298 @@
+/**
+ * @file        codec.h
+ * @brief       PAX页中minipage的压缩编码，写页时为每个minipage选择最短的编码
+ *              minipage首字节为编码类型：
+ *              int属性：
+ *                  plain：xxxx ...  各行的值
+ *                  FOR：xxxx x ...  页内最小值 位宽 各行与最小值之差（按位宽紧密排列）
+ *                  RLE：xx (xx xxxx) ...  段数 （段结束槽号 值）...
+ *              string属性：
+ *                  plain：xx ... xxxxxx  各行结束位置（最高位为溢出标志） 数据
+ *                  字典：xx xx ... xxxxxx (int minipage)  字典项数 各项结束位置 字典数据 各行字典编码
+ *              字典编码按int属性的方式再次编码，等值条件可直接与字典编码比较
+ * @author      hjb
+ * @version     1.0
+ * @date        2023-12-09
+ * @copyright   Copyright (c) 2023
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "rowFormat.h"
+
+namespace bpT {
+using namespace std;
+
+enum codecType : uint8_t {
+    plainCodec = 0,
+    forCodec = 1,
+    rleCodec = 2,
+    dictCodec = 3
+};
+
+/**
+* @brief   按位宽写入第i个值
+* @param   p       紧密排列区起始位置
+* @param   bits    位宽
+* @param   i       下标
+* @param   v       值
+*/
+inline void packBits(char *p, int bits, size_t i, uint32_t v) {
+    size_t bit = i * bits;
+    for (auto k = 0; k < bits; ++k, ++bit) {
+        if (v >> k & 1) {
+            p[bit / 8] |= (char)(1 << (bit % 8));
+        }
+    }
+}
+/**
+* @brief   按位宽读取第i个值
+* @param   p       紧密排列区起始位置
+* @param   bits    位宽
+* @param   i       下标
+* @return  uint32_t
+*/
+inline uint32_t unpackBits(const char *p, int bits, size_t i) {
+    size_t bit = i * bits;
+    uint32_t v = 0;
+    for (auto k = 0; k < bits;) {
+        int n = min(8 - (int)(bit % 8), bits - k);
+        uint32_t byte = (uint8_t)p[bit / 8] >> (bit % 8);
+        v |= (byte & ((1u << n) - 1)) << k;
+        k += n;
+        bit += n;
+    }
+    return v;
+}
+
+/**
+* @brief   编码int minipage，在plain、FOR、RLE中选择最短的
+* @param   v   各行的值
+* @return  string
+*/
+inline string encodeInts(const vector<int> &v) {
+    size_t n = v.size();
+    string best(1 + 4 * n, 0);
+    best[0] = plainCodec;
+    memcpy(best.data() + 1, v.data(), 4 * n);
+    if (n == 0) {
+        return best;
+    }
+    // FOR
+    int64_t lo = v[0], hi = v[0];
+    for (auto i : v) {
+        lo = min(lo, (int64_t)i);
+        hi = max(hi, (int64_t)i);
+    }
+    uint64_t range = hi - lo;
+    int bits = 0;
+    while (bits < 32 && (range >> bits) != 0) {
+        bits++;
+    }
+    size_t forSize = 1 + 4 + 1 + (n * bits + 7) / 8;
+    if (forSize < best.size()) {
+        string res(forSize, 0);
+        int base = lo;
+        res[0] = forCodec;
+        memcpy(res.data() + 1, &base, 4);
+        res[5] = bits;
+        for (auto i = 0uz; i < n; ++i) {
+            packBits(res.data() + 6, bits, i, (uint32_t)((int64_t)v[i] - lo));
+        }
+        best = res;
+    }
+    // RLE
+    size_t runs = 1;
+    for (auto i = 1uz; i < n; ++i) {
+        runs += v[i] != v[i - 1];
+    }
+    size_t rleSize = 1 + 2 + 6 * runs;
+    if (rleSize < best.size()) {
+        string res(rleSize, 0);
+        res[0] = rleCodec;
+        uint16_t cnt = runs;
+        memcpy(res.data() + 1, &cnt, 2);
+        size_t pos = 3;
+        for (auto i = 0uz; i < n; ++i) {
+            if (i + 1 == n || v[i + 1] != v[i]) {
+                uint16_t end = i + 1;
+                memcpy(res.data() + pos, &end, 2);
+                memcpy(res.data() + pos + 2, &v[i], 4);
+                pos += 6;
+            }
+        }
+        best = res;
+    }
+    return best;
+}
+/**
+* @brief   读取int minipage中第s行的值
+* @param   p   minipage起始位置
+* @param   s   槽号
+* @return  int
+*/
+inline int intAt(const char *p, size_t s) {
+    int v = 0;
+    switch ((uint8_t)p[0]) {
+    case forCodec:
+        memcpy(&v, p + 1, 4);
+        return (int)((int64_t)v + unpackBits(p + 6, (uint8_t)p[5], s));
+    case rleCodec: {
+        uint16_t runs = 0;
+        memcpy(&runs, p + 1, 2);
+        size_t lo = 0, hi = runs; // 二分查找首个结束槽号大于s的段
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            uint16_t end = 0;
+            memcpy(&end, p + 3 + 6 * mid, 2);
+            if (end > s) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        memcpy(&v, p + 3 + 6 * lo + 2, 4);
+        return v;
+    }
+    default:
+        memcpy(&v, p + 1 + 4 * s, 4);
+        return v;
+    }
+}
+
+/**
+* @brief   编码string minipage，在plain与字典编码中选择较短的
+* @param   v   各行的数据或溢出引用
+* @param   ext 各行是否溢出
+* @return  string
+*/
+inline string encodeStrs(const vector<string> &v, const vector<char> &ext) {
+    size_t n = v.size(), bytes = 0;
+    for (auto &i : v) {
+        bytes += i.size();
+    }
+    string best(1 + 2 * n + bytes, 0);
+    best[0] = plainCodec;
+    uint16_t end = 0;
+    for (auto i = 0uz; i < n; ++i) {
+        memcpy(best.data() + 1 + 2 * n + end, v[i].data(), v[i].size());
+        end += v[i].size();
+        uint16_t e = end | (ext[i] ? extFlag : 0);
+        memcpy(best.data() + 1 + 2 * i, &e, 2);
+    }
+    // 字典
+    unordered_map<string, int> ids;
+    vector<int> entries, codes(n);
+    size_t dictBytes = 0;
+    for (auto i = 0uz; i < n; ++i) {
+        auto r = ids.try_emplace(string(1, ext[i]) + v[i], entries.size());
+        if (r.second) {
+            entries.push_back(i);
+            dictBytes += v[i].size();
+        }
+        codes[i] = r.first->second;
+    }
+    if (3 + 2 * entries.size() + dictBytes >= best.size()) {
+        return best;
+    }
+    auto packed = encodeInts(codes);
+    size_t dictSize = 1 + 2 + 2 * entries.size() + dictBytes + packed.size();
+    if (dictSize < best.size()) {
+        string res(dictSize, 0);
+        res[0] = dictCodec;
+        uint16_t cnt = entries.size();
+        memcpy(res.data() + 1, &cnt, 2);
+        size_t base = 3 + 2 * entries.size();
+        uint16_t end = 0;
+        for (auto k = 0uz; k < entries.size(); ++k) {
+            auto &s = v[entries[k]];
+            memcpy(res.data() + base + end, s.data(), s.size());
+            end += s.size();
+            uint16_t e = end | (ext[entries[k]] ? extFlag : 0);
+            memcpy(res.data() + 3 + 2 * k, &e, 2);
+        }
+        memcpy(res.data() + base + end, packed.data(), packed.size());
+        best = res;
+    }
+    return best;
+}
+
+/**
+* @brief   字典编码minipage中的字典项
+* @param   p       minipage起始位置
+* @param   code    字典编码
+* @param   ext     输出，该项是否为溢出引用
+* @return  string_view
+*/
+inline string_view dictEntry(const char *p, int code, bool &ext) {
+    uint16_t cnt = 0, beg = 0, end = 0;
+    memcpy(&cnt, p + 1, 2);
+    if (code > 0) {
+        memcpy(&beg, p + 3 + 2 * (code - 1), 2);
+        beg &= ~extFlag;
+    }
+    memcpy(&end, p + 3 + 2 * code, 2);
+    ext = (end & extFlag) != 0;
+    end &= ~extFlag;
+    return string_view(p + 3 + 2 * cnt + beg, end - beg);
+}
+/**
+* @brief   字典编码minipage中第s行的字典编码
+* @param   p   minipage起始位置
+* @param   s   槽号
+* @return  int
+*/
+inline int dictCode(const char *p, size_t s) {
+    uint16_t cnt = 0, last = 0;
+    memcpy(&cnt, p + 1, 2);
+    memcpy(&last, p + 3 + 2 * (cnt - 1), 2);
+    last &= ~extFlag;
+    return intAt(p + 3 + 2 * cnt + last, s);
+}
+/**
+* @brief   在字典中查找值，溢出引用不参与比较
+* @param   p   minipage起始位置
+* @param   v   值
+* @return  int 字典编码，不存在时为-1
+*/
+inline int dictFind(const char *p, string_view v) {
+    uint16_t cnt = 0;
+    memcpy(&cnt, p + 1, 2);
+    for (auto k = 0; k < cnt; ++k) {
+        bool ext = false;
+        if (dictEntry(p, k, ext) == v && !ext) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+/**
+* @brief   读取string minipage中第s行的值
+* @param   p   minipage起始位置
+* @param   n   行数
+* @param   s   槽号
+* @param   ext 输出，是否为溢出引用
+* @return  string_view
+*/
+inline string_view strAt(const char *p, size_t n, size_t s, bool &ext) {
+    if ((uint8_t)p[0] == dictCodec) {
+        return dictEntry(p, dictCode(p, s), ext);
+    }
+    uint16_t beg = 0, end = 0;
+    if (s > 0) {
+        memcpy(&beg, p + 1 + 2 * (s - 1), 2);
+        beg &= ~extFlag;
+    }
+    memcpy(&end, p + 1 + 2 * s, 2);
+    ext = (end & extFlag) != 0;
+    end &= ~extFlag;
+    return string_view(p + 1 + 2 * n + beg, end - beg);
+}
+}
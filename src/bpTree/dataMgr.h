@@ -1,21 +1,45 @@
 /**
  * @file        dataMgr.h
  * @brief       磁盘数据写入及读取
- *              table.dat    数据文件
- *                  record:
- *                  # record头
- *                  00000000 00000000 00000000 00000000
- *                    byte1    byte2    byte3    byte4
- *                  byte1：记录R占有的record总数，首条为(sizeof(R)-4)/maxRecSize+1，不为首条均为0
- *                  byte2：该record长度的第一个字节
- *                  byte3：该record长度的第二个字节
- *                  byte4：下一个record位置，已是末尾则为0
- *                  # record数据
- *                  xxxxxx
+ *              table.dat    数据文件，由maxPageSize大小的页组成
+ *                  page:
+ *                  # 页头（8个字节）
+ *                  xx xx xx xx
+ *                  slotNums freeBeg freeEnd flags
+ *                  slotNums：槽目录中的槽数
+ *                  freeBeg：空闲区起始位置，即槽目录末尾
+ *                  freeEnd：空闲区结束位置，即tuple区起始
+ *                  flags：页类型，0为数据页，1为溢出页，2为PAX页
+ *                  # 槽目录（每个槽4个字节）
+ *                  xx xx
+ *                  offset size
+ *                  size为0表示空槽，最高位为1表示tuple已迁移，tuple中存放新位置的rid
+ *                  # 空闲区
+ *                  # tuple区（从页尾向前紧密排列）
+ *                  xxxxxx 行数据，格式见rowFormat.h
+ *                  rid:
+ *                  页号 << slotBits | 槽号，存放于b+树叶子节点中
+ *                  overflow page:
+ *                  # 页头（8个字节，同上）
+ *                  slotNums为0，freeBeg为本页数据长度
+ *                  # 后继页页号（4个字节，-1表示链尾）
+ *                  xxxx
+ *                  # 数据
+ *                  xxxxxx 超过maxRecSize的行中被移出的string
+ *                  PAX page（列存表）:
+ *                  # 页头（8个字节，同上）
+ *                  slotNums为槽数，freeBeg为页内已用长度
+ *                  # minipage目录（每个属性2个字节）
+ *                  xx ...  各属性minipage在页内的起始位置
+ *                  # 槽目录（每个槽4个字节）
+ *                  xxxx ...  -1为有效行，-2为空槽，否则为行迁移后的rid
+ *                  # minipage（每个属性一个）
+ *                  x ...  编码类型及编码后的数据，写页时自动选择，格式见codec.h
+ *              table.fsm  空闲空间映射表
+ *                  每页对应1个字节：0为未知（需读取数据页计算），否则为页内可用空间/fsmUnit+1
  *              table.ind  索引文件
- *                  line1：b+Tree层序遍历序列
- *                  line2：bpTree结构中indexs数组
- *                  line3：bpTree结构中叶子节点数据
+ *                  由maxPageSize大小的页组成，第0页为元数据页，其余为b+树节点页，格式见nodePage.h
+ *                  缺失或无法识别时由数据文件重建
  *              table.prof   配置文件
  *                  # 前4个字节
  *                  xxxx 主键类型int/string
@@ -25,8 +49,10 @@
  *                  xxxx 表属性个数n
  *                  # 次n个字节
  *                  x    对应属性是否为int类型
- *                  # 后4个字节
- *                  xxxx dat文件写指针位置
+ *                  # 偏移maxPropSize处
+ *                  xxxx 格式标记profMark，不符（如旧版本在此处存放的写指针）时不识别该表
+ *                  xxxx 表选项，见optAutoVacuum、optColumnStore
+ *                  其后为二级索引及组合主键，见catalog::readProf
  * @author      hjb
  * @version     1.0
  * @date        2023-11-21
@@ -39,7 +65,14 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <string_view>
+#include <unordered_set>
+#include <sys/mman.h>
 #include "../utility.h"
+#include "bufferPool.h"
+#include "codec.h"
+#include "prefetch.h"
+#include "rowFormat.h"
 
 namespace bpT {
 using namespace std;
@@ -48,138 +81,735 @@ static const string dataPos = "data/";
 static const size_t maxRecSize = 256 - 1;
 static const size_t maxPageSize = 8 * 1024;
 static const size_t maxPropSize = 1024 - 4;
-static const size_t bpTreeLevel = 3;
+static const uint32_t profMark = 0x6e765101;    // .prof格式标记，高24位为魔数，低8位为版本号
+static const size_t bufferPoolSize = 64 * 1024 * 1024;   // 缓冲池的初始内存预算，可由set pool修改
+static const int slotBits = 10;
+static const size_t fsmUnit = 32;
+static const int vacuumPages = 4;
+static const double vacuumRatio = 0.5;
+static const double bulkFill = 0.9;     // 批量建立索引时节点的填充率
+static const int optAutoVacuum = 1;     // delete后自动vacuum
+static const int optColumnStore = 2;    // 以PAX页存储
 
 /**
-* @brief   记录
+* @brief   由页号与槽号组成rid
+* @param   pageNo
+* @param   slot
+* @return  int
 */
-struct record {
+inline int makeRid(int pageNo, int slot) {
+    return (pageNo << slotBits) | slot;
+}
+inline int ridPage(int rid) {
+    return rid >> slotBits;
+}
+inline int ridSlot(int rid) {
+    return rid & ((1 << slotBits) - 1);
+}
+
+/**
+* @brief   全局共享的页缓冲池
+* @return  bufferPool&
+*/
+inline bufferPool &pool() {
+    static bufferPool _pool(maxPageSize, bufferPoolSize);
+    return _pool;
+}
+
+/**
+* @brief   slotted page，对缓冲池中的一页进行解释
+*/
+struct heapPage {
 public:
-    using value_type = char;
-    value_type data[maxRecSize];
-    uint16_t size = 0;
+    struct header {
+        uint16_t slotNums;  // 槽数
+        uint16_t freeBeg;   // 空闲区起始
+        uint16_t freeEnd;   // 空闲区结束
+        uint16_t flags;     // 页类型
+    };
+    struct slot {
+        uint16_t offset;    // tuple在页内偏移
+        uint16_t size;      // tuple长度，0为空槽
+    };
+    static const uint16_t forwardFlag = 0x8000;
+    static const uint16_t minTuple = 4;     // tuple至少占用的字节数，足以原地改写为迁移记录
+    static const uint16_t overflowFlag = 1;
+    static const uint16_t paxFlag = 2;
 
-    record() {
-        memset(data, 0, maxRecSize);
-        size = 4;
+    char *data;
+
+    heapPage(char *page) {
+        this->data = page;
+        if (head()->freeEnd == 0) { // 新页
+            head()->slotNums = 0;
+            head()->freeBeg = sizeof(header);
+            head()->freeEnd = maxPageSize;
+            head()->flags = 0;
+        }
     }
-    record(string s, bool _endr = true) : record() {
-        if (_endr) {
-            data[0] = 1;
-        } else {
-            data[0] = 0;
+
+    header *head() {
+        return (header *)data;
+    }
+    slot *slots() {
+        return (slot *)(data + sizeof(header));
+    }
+
+    /**
+    * @brief   槽是否存放tuple
+    * @param   s   槽号
+    */
+    bool valid(int s) {
+        return s < head()->slotNums && slots()[s].size != 0;
+    }
+    /**
+    * @brief   tuple是否已迁移
+    * @param   s   槽号
+    */
+    bool forwarded(int s) {
+        return (slots()[s].size & forwardFlag) != 0;
+    }
+    /**
+    * @brief   已迁移tuple的新位置
+    * @param   s   槽号
+    * @return  int rid
+    */
+    int forwardRid(int s) {
+        int rid = -1;
+        memcpy(&rid, data + slots()[s].offset, 4);
+        return rid;
+    }
+    /**
+    * @brief   槽中的tuple
+    * @param   s   槽号
+    * @return  string_view
+    */
+    string_view get(int s) {
+        auto &sl = slots()[s];
+        return string_view(data + sl.offset, sl.size & ~forwardFlag);
+    }
+    /**
+    * @brief   长度为n的tuple在页内实际占用的字节数，不足minTuple时按minTuple计
+    * @param   n   tuple长度，0为空槽
+    * @return  size_t
+    */
+    static size_t footprint(size_t n) {
+        n &= ~forwardFlag;
+        return n == 0 ? 0 : max(n, (size_t)minTuple);
+    }
+
+    /**
+    * @brief   连续空闲空间
+    * @return  size_t
+    */
+    size_t freeSpace() {
+        return head()->freeEnd - head()->freeBeg;
+    }
+    /**
+    * @brief   整理后可用的空闲空间
+    * @return  size_t
+    */
+    size_t reclaimable() {
+        if (head()->flags != 0) {
+            return 0;
+        }
+        size_t used = 0;
+        for (auto i = 0; i < head()->slotNums; ++i) {
+            used += footprint(slots()[i].size);
         }
-        push_back(s);
+        return maxPageSize - head()->freeBeg - used;
     }
-    record(int v, bool _endr = true) : record() {
-        if (_endr) {
-            data[0] = 1;
-        } else {
-            data[0] = 0;
+
+    /**
+    * @brief   插入tuple，优先复用空槽
+    * @param   t   tuple
+    * @return  int 槽号，空间不足返回-1
+    */
+    int insert(string_view t) {
+        if (head()->flags != 0) {
+            return -1;
+        }
+        int s = -1;
+        for (auto i = 0; i < head()->slotNums; ++i) {
+            if (slots()[i].size == 0) {
+                s = i;
+                break;
+            }
+        }
+        size_t need = footprint(t.size()) + (s == -1 ? sizeof(slot) : 0);
+        if (s == -1 && head()->slotNums >= (1 << slotBits)) {
+            return -1;
         }
-        push_back(v);
+        if (freeSpace() < need) {
+            if (reclaimable() < need) {
+                return -1;
+            }
+            compact();
+        }
+        if (s == -1) {
+            s = head()->slotNums++;
+            head()->freeBeg += sizeof(slot);
+        }
+        place(s, t);
+        return s;
     }
 
     /**
-    * @brief   插入string数据
-    * @param   s
+    * @brief   原地更新tuple
+    * @param   s   槽号
+    * @param   t   tuple
+    * @return  true    成功
+    * @return  false   页内空间不足
+    */
+    bool update(int s, string_view t) {
+        auto &sl = slots()[s];
+        size_t old = footprint(sl.size), need = footprint(t.size());
+        if (need <= old) { // 原有空间不小于minTuple，缩短后仍可改写为迁移记录
+            memcpy(data + sl.offset, t.data(), t.size());
+            sl.size = t.size();
+            return true;
+        }
+        if (freeSpace() < need) {
+            if (reclaimable() + old < need) {
+                return false;
+            }
+            sl.size = 0;
+            sl.offset = 0;
+            compact();
+        }
+        place(s, t);
+        return true;
+    }
+
+    /**
+    * @brief   将槽改写为指向新位置的迁移记录，tuple至少占用minTuple个字节，迁移记录可原地写入
+    * @param   s   槽号
+    * @param   rid 新位置
     */
-    void push_back(string s) {
-        int _size = s.size();
-        convert(_size);
-        convert(s);
+    void forward(int s, int rid) {
+        auto &sl = slots()[s];
+        memcpy(data + sl.offset, &rid, 4);
+        sl.size = 4 | forwardFlag;
     }
+
     /**
-    * @brief   插入int数据
-    * @param   v
+    * @brief   删除tuple，槽置空以便复用
+    * @param   s   槽号
     */
-    void push_back(int v) {
-        int _size = 4;
-        convert(_size);
-        convert(v);
+    void erase(int s) {
+        slots()[s].size = 0;
+        slots()[s].offset = 0;
+        while (head()->slotNums > 0 && slots()[head()->slotNums - 1].size == 0) {
+            head()->slotNums--;
+            head()->freeBeg -= sizeof(slot);
+        }
     }
 
     /**
-    * @brief   存储到磁盘
-    * @param   f
+    * @brief   页是否为空的数据页
     */
-    void save(fstream &f) {
-        int _size = size - 4;
-        memcpy(data + 1, &_size, 2);
-        f.write(data, maxRecSize);
+    bool empty() {
+        return head()->slotNums == 0 && head()->flags == 0;
     }
 
     /**
-    * @brief   数据装入record结构体
-    * @param   v
-    * @return  size_t record剩余空间
+    * @brief   整理页，使所有tuple紧密排列于页尾
     */
-    size_t fill(vector<string> &v) {
-        auto n = v.size();
-        for (auto i = 0uz; i < n; ++i) {
-            if (v[i].front() == 'i') {
-                if (size + 4 + 4 >= (int)maxRecSize) {
+    void compact() {
+        string buf(maxPageSize, 0);
+        uint16_t end = maxPageSize;
+        for (auto i = 0; i < head()->slotNums; ++i) {
+            auto &sl = slots()[i];
+            uint16_t n = footprint(sl.size);
+            if (n == 0) {
+                continue;
+            }
+            end -= n;
+            memcpy(buf.data() + end, data + sl.offset, n);
+            sl.offset = end;
+        }
+        memcpy(data + end, buf.data() + end, maxPageSize - end);
+        head()->freeEnd = end;
+    }
+
+private:
+    /**
+    * @brief   在空闲区末尾放置tuple
+    * @param   s   槽号
+    * @param   t   tuple
+    */
+    void place(int s, string_view t) {
+        head()->freeEnd -= footprint(t.size());
+        memcpy(data + head()->freeEnd, t.data(), t.size());
+        slots()[s].offset = head()->freeEnd;
+        slots()[s].size = t.size();
+    }
+};
+
+/**
+* @brief   溢出页，对缓冲池中的一页进行解释
+*/
+struct overflowPage {
+public:
+    static const size_t capacity = maxPageSize - sizeof(heapPage::header) - 4;
+
+    char *data;
+
+    overflowPage(char *page) {
+        this->data = page;
+    }
+
+    heapPage::header *head() {
+        return (heapPage::header *)data;
+    }
+    /**
+    * @brief   后继页页号
+    * @return  int -1表示链尾
+    */
+    int next() {
+        int n = -1;
+        memcpy(&n, data + sizeof(heapPage::header), 4);
+        return n;
+    }
+    void setNext(int n) {
+        memcpy(data + sizeof(heapPage::header), &n, 4);
+    }
+    /**
+    * @brief   本页数据
+    * @return  string_view
+    */
+    string_view get() {
+        return string_view(data + sizeof(heapPage::header) + 4, head()->freeBeg);
+    }
+    /**
+    * @brief   写入数据并标记为溢出页
+    * @param   t       数据，长度不超过capacity
+    * @param   n       后继页页号
+    */
+    void put(string_view t, int n) {
+        head()->slotNums = 0;
+        head()->freeBeg = t.size();
+        head()->freeEnd = maxPageSize;
+        head()->flags = heapPage::overflowFlag;
+        setNext(n);
+        memcpy(data + sizeof(heapPage::header) + 4, t.data(), t.size());
+    }
+};
+
+/**
+* @brief   PAX页，页内每个属性的值集中存放于各自的minipage中，对缓冲池中的一页进行解释
+*/
+struct paxPage {
+public:
+    static constexpr int liveTag = -1;
+    static constexpr int emptyTag = -2;
+
+    /**
+    * @brief   页内容按列解码后的结果，修改后经store写回
+    */
+    struct columns {
+        vector<int> tags;               // 槽目录
+        vector<vector<string>> parts;   // parts[属性][槽]，int属性为4个字节，string属性为数据或溢出引用
+        vector<vector<char>> ext;       // ext[属性][槽]，string属性是否已溢出
+
+        /**
+        * @brief   取得一个槽，优先复用空槽
+        * @return  int 槽号，槽数已满返回-1
+        */
+        int add() {
+            for (auto i = 0uz; i < tags.size(); ++i) {
+                if (tags[i] == emptyTag) {
                     return i;
                 }
-                v[i].erase(0, 1);
-                int iData = atoi(v[i].c_str());
-                push_back(iData);
-            } else {
-                if (size + v[i].size() + 4 > (int)maxRecSize) {
-                    return i;
+            }
+            if (tags.size() >= (1uz << slotBits)) {
+                return -1;
+            }
+            tags.push_back(emptyTag);
+            for (auto a = 0uz; a < parts.size(); ++a) {
+                parts[a].push_back("");
+                ext[a].push_back(0);
+            }
+            return tags.size() - 1;
+        }
+        /**
+        * @brief   将行拆分到各属性中
+        * @param   s       槽号
+        * @param   row     行
+        * @param   layout  行布局
+        */
+        void set(int s, string_view row, const rowLayout &layout) {
+            tags[s] = liveTag;
+            for (auto a = 0uz; a < layout.size(); ++a) {
+                if (layout.isInt(a)) {
+                    parts[a][s] = row.substr(layout.intOffset(a), 4);
+                } else {
+                    parts[a][s] = layout.span(row, a);
+                    ext[a][s] = layout.external(row, a);
                 }
-                v[i].erase(0, 1);
-                string sData = v[i];
-                push_back(sData);
             }
         }
-        return n;
+        /**
+        * @brief   清空槽中的值并设置槽目录，末尾的空槽一并去除
+        * @param   s       槽号
+        * @param   tag     emptyTag或迁移后的rid
+        * @param   layout  行布局
+        */
+        void clear(int s, int tag, const rowLayout &layout) {
+            tags[s] = tag;
+            for (auto a = 0uz; a < layout.size(); ++a) {
+                parts[a][s] = layout.isInt(a) ? string(4, 0) : "";
+                ext[a][s] = 0;
+            }
+            while (!tags.empty() && tags.back() == emptyTag) {
+                tags.pop_back();
+                for (auto a = 0uz; a < parts.size(); ++a) {
+                    parts[a].pop_back();
+                    ext[a].pop_back();
+                }
+            }
+        }
+    };
+
+    char *data;
+    const rowLayout *layout;
+
+    paxPage(char *page, const rowLayout &layout) {
+        this->data = page;
+        this->layout = &layout;
     }
 
+    heapPage::header *head() {
+        return (heapPage::header *)data;
+    }
+    bool isPax() {
+        return head()->flags == heapPage::paxFlag;
+    }
+    int count() {
+        return isPax() ? head()->slotNums : 0;
+    }
     /**
-    * @brief   写入文件头
-    * @param   v
+    * @brief   页内可用空间
+    * @return  size_t
     */
-    void make_head(int v) {
-        memcpy(data, &v, 4);
+    size_t freeSpace() {
+        return isPax() ? maxPageSize - head()->freeBeg : maxPageSize - sizeof(heapPage::header);
     }
 
     /**
-    * @brief   打印record中数据
-    * @param   os
-    * @param   r
-    * @return  ostream&
+    * @brief   槽目录项
+    * @param   s   槽号
+    * @return  int -1为有效行，-2为空槽，否则为迁移后的rid
     */
-    friend ostream &operator<<(ostream &os, record &r) {
-        os << r.data << endl;
-        return os;
+    int tag(int s) {
+        int t = emptyTag;
+        memcpy(&t, data + tagOffset() + 4 * s, 4);
+        return t;
+    }
+    bool valid(int s) {
+        return s < count() && tag(s) != emptyTag;
+    }
+    bool forwarded(int s) {
+        return tag(s) >= 0;
+    }
+
+    /**
+    * @brief   属性a的minipage起始位置
+    * @param   a   属性下标
+    * @return  size_t
+    */
+    size_t miniOffset(int a) {
+        uint16_t off = 0;
+        memcpy(&off, data + sizeof(heapPage::header) + 2 * a, 2);
+        return off;
+    }
+    /**
+    * @brief   int属性的值
+    * @param   a   属性下标
+    * @param   s   槽号
+    * @return  int
+    */
+    int getInt(int a, int s) {
+        return intAt(data + miniOffset(a), s);
+    }
+    /**
+    * @brief   string属性的值，溢出的string为其引用
+    * @param   a   属性下标
+    * @param   s   槽号
+    * @return  string_view 指向页内数据
+    */
+    string_view span(int a, int s) {
+        bool ext = false;
+        return strAt(data + miniOffset(a), count(), s, ext);
+    }
+    bool external(int a, int s) {
+        bool ext = false;
+        strAt(data + miniOffset(a), count(), s, ext);
+        return ext;
+    }
+
+    /**
+    * @brief   string属性的minipage是否为字典编码
+    * @param   a   属性下标
+    */
+    bool isDict(int a) {
+        return (uint8_t)data[miniOffset(a)] == dictCodec;
+    }
+    /**
+    * @brief   在字典编码的minipage中查找值
+    * @param   a   属性下标
+    * @param   v   值
+    * @return  int 字典编码，不存在时为-1
+    */
+    int findCode(int a, string_view v) {
+        return dictFind(data + miniOffset(a), v);
+    }
+    /**
+    * @brief   槽中string属性是否可能等于v，溢出的string无法在页内判断，视为可能相等
+    * @param   a       属性下标
+    * @param   s       槽号
+    * @param   v       值
+    * @param   code    字典编码的minipage中v的编码（见findCode），否则忽略
+    */
+    bool mayEqual(int a, int s, string_view v, int code) {
+        const char *p = data + miniOffset(a);
+        bool ext = false;
+        if (isDict(a)) {
+            int k = dictCode(p, s);
+            if (k == code) {
+                return true;
+            }
+            dictEntry(p, k, ext);
+            return ext;
+        }
+        return strAt(p, count(), s, ext) == v || ext;
+    }
+
+    /**
+    * @brief   将槽中的行还原为行格式，只读取需要的属性
+    * @param   s       槽号
+    * @param   cols    需要的属性下标，为空表示全部属性，其余属性以0或空串填充
+    * @return  string
+    */
+    string row(int s, const vector<int> &cols) {
+        auto n = layout->size();
+        vector<char> want(n, cols.empty());
+        for (auto i : cols) {
+            want[i] = 1;
+        }
+        vector<int> ivals(n, 0);
+        vector<string_view> parts(n);
+        vector<char> ext(n, 0);
+        for (auto a = 0uz; a < n; ++a) {
+            if (layout->isInt(a)) {
+                ivals[a] = want[a] ? getInt(a, s) : 0;
+                parts[a] = string_view((char *)&ivals[a], 4);
+            } else if (want[a]) {
+                parts[a] = span(a, s);
+                ext[a] = external(a, s);
+            }
+        }
+        return layout->build(parts, ext);
+    }
+
+    /**
+    * @brief   按列解码整页
+    * @return  columns
+    */
+    columns load() {
+        columns c;
+        int n = count();
+        c.tags.resize(n);
+        c.parts.assign(layout->size(), vector<string>(n));
+        c.ext.assign(layout->size(), vector<char>(n, 0));
+        for (auto s = 0; s < n; ++s) {
+            c.tags[s] = tag(s);
+            for (auto a = 0uz; a < layout->size(); ++a) {
+                if (layout->isInt(a)) {
+                    int v = getInt(a, s);
+                    c.parts[a][s] = string((char *)&v, 4);
+                } else {
+                    c.parts[a][s] = span(a, s);
+                    c.ext[a][s] = external(a, s);
+                }
+            }
+        }
+        return c;
+    }
+
+    /**
+    * @brief   将列数据编码写回页，每个minipage选择最短的编码（见codec.h），没有槽时写为空的数据页
+    * @param   c
+    * @return  true    成功
+    * @return  false   超出页大小，页保持不变
+    */
+    bool store(columns &c) {
+        size_t n = c.tags.size(), nAttr = layout->size();
+        if (n == 0) {
+            memset(data, 0, sizeof(heapPage::header));
+            heapPage hp(data);
+            return true;
+        }
+        vector<string> minis(nAttr);
+        size_t total = sizeof(heapPage::header) + 2 * nAttr + 4 * n;
+        for (auto a = 0uz; a < nAttr; ++a) {
+            if (layout->isInt(a)) {
+                vector<int> v(n);
+                for (auto s = 0uz; s < n; ++s) {
+                    memcpy(&v[s], c.parts[a][s].data(), 4);
+                }
+                minis[a] = encodeInts(v);
+            } else {
+                minis[a] = encodeStrs(c.parts[a], c.ext[a]);
+            }
+            total += minis[a].size();
+        }
+        if (total > maxPageSize) {
+            return false;
+        }
+        string buf(total, 0);
+        heapPage::header h{(uint16_t)n, (uint16_t)total, (uint16_t)maxPageSize, heapPage::paxFlag};
+        memcpy(buf.data(), &h, sizeof(h));
+        memcpy(buf.data() + tagOffset(), c.tags.data(), 4 * n);
+        size_t pos = tagOffset() + 4 * n;
+        for (auto a = 0uz; a < nAttr; ++a) {
+            uint16_t off = pos;
+            memcpy(buf.data() + sizeof(heapPage::header) + 2 * a, &off, 2);
+            memcpy(buf.data() + pos, minis[a].data(), minis[a].size());
+            pos += minis[a].size();
+        }
+        memcpy(data, buf.data(), total);
+        return true;
     }
 
 private:
+    size_t tagOffset() {
+        return sizeof(heapPage::header) + 2 * layout->size();
+    }
+};
+
+/**
+* @brief   数据文件的只读内存映射，供批量读取直接访问页中的tuple
+*          复制时不共享映射，副本在首次使用时重新映射
+*/
+struct fileMap {
+public:
+    const char *data = nullptr; // 映射起始地址
+    size_t size = 0;            // 映射长度
+
+    fileMap() = default;
+    fileMap(const fileMap &) {}
+    fileMap &operator=(const fileMap &) {
+        unmap();
+        return *this;
+    }
+    ~fileMap() {
+        unmap();
+    }
+
     /**
-    * @brief   string类型的数据转为char*
-    * @param   s
+    * @brief   保证映射覆盖文件当前长度，文件长度变化时重新映射
+    * @param   filename
+    * @return  true    映射可用
+    * @return  false   文件为空或无法映射
     */
-    void convert(string &s) {
-        memcpy(data + size, s.data(), s.size());
-        size += s.size();
+    bool remap(const string &filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            unmap();
+            return false;
+        }
+        struct stat st;
+        size_t fileSize = fstat(fd, &st) == 0 ? st.st_size : 0;
+        if (fileSize != size) {
+            unmap();
+            if (fileSize > 0) {
+                void *p = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+                if (p != MAP_FAILED) {
+                    data = (const char *)p;
+                    size = fileSize;
+                }
+            }
+        }
+        close(fd);
+        return data != nullptr;
     }
+
     /**
-    * @brief   int类型的数据转为char*
-    * @param   v
+    * @brief   解除映射
     */
-    void convert(int &v) {
-        memcpy(data + size, &v, 4);
-        size += 4;
+    void unmap() {
+        if (data != nullptr) {
+            munmap((void *)data, size);
+        }
+        data = nullptr;
+        size = 0;
+    }
+
+    /**
+    * @brief   某页在映射中的起始地址
+    * @param   pageNo
+    * @return  const char* 页不在映射范围内时为nullptr
+    */
+    const char *page(int pageNo) const {
+        size_t offset = (size_t)pageNo * maxPageSize;
+        if (offset + maxPageSize > size) {
+            return nullptr;
+        }
+        return data + offset;
+    }
+
+    /**
+    * @brief   rid处的tuple，已迁移的tuple返回其新位置的数据
+    * @param   rid
+    * @return  string_view 指向映射内存，记录不存在时为空
+    */
+    string_view tuple(int rid) const {
+        size_t offset = (size_t)ridPage(rid) * maxPageSize;
+        if (offset + maxPageSize > size) {
+            return string_view();
+        }
+        const char *page = data + offset;
+        auto head = (const heapPage::header *)page;
+        int s = ridSlot(rid);
+        if (s >= head->slotNums) {
+            return string_view();
+        }
+        auto sl = ((const heapPage::slot *)(page + sizeof(heapPage::header)))[s];
+        if (sl.size & heapPage::forwardFlag) {
+            int to = -1;
+            memcpy(&to, page + sl.offset, 4);
+            return tuple(to);
+        }
+        return string_view(page + sl.offset, sl.size);
     }
 };
 
+/**
+* @brief   批量读取时下推到列存表页内的属性裁剪与等值条件
+*/
+struct scanFilter {
+    vector<int> cols;                   // 需要的属性下标，为空表示全部属性
+    vector<pair<int, string>> equals;   // string属性的等值条件，字典编码的minipage直接比较编码
+};
+
 /**
 * @brief   bpTree对象的辅助结构体，负责数据在磁盘上的写入与读取
 */
 class dataMgr {
 private:
     string filename = dataPos + "db/" + "table.dat";    // 表的dat文件路径
+    string fsmFilename = dataPos + "db/" + "table.fsm"; // 表的fsm文件路径
+    int fsmHint = 0;            // 插入时查找空闲页的起始页号
+    fileMap fmap;               // 批量读取使用的只读映射
+    prefetcher prefetch;        // 批量读取时的异步预取
+    vector<int> freePages;      // 可供溢出链复用的空页
+    bool freeScanned = false;   // 是否已从空闲空间映射表中收集空页
+    rowLayout layout;           // 表的行布局
+    bool columnar = false;      // 是否以PAX页存储
+    vector<string> rowBuf;      // 列存表批量读取时还原出的行
+    int codePage = -1;          // filterCodes所属的页号
+    vector<int> filterCodes;    // 等值条件在codePage字典中的编码
     string database = "db";     // 数据库名
     string table = "table";     // 表名
     int keyType = 1; // string : 0; int : 1;
@@ -205,6 +835,22 @@ public:
         this->keyType = key_type;
     }
 
+    /**
+    * @brief   设置表的行布局
+    * @param   layout
+    */
+    void setLayout(const rowLayout &layout) {
+        this->layout = layout;
+    }
+
+    /**
+    * @brief   设置表是否以PAX页存储
+    * @param   columnar
+    */
+    void setColumnar(bool columnar) {
+        this->columnar = columnar;
+    }
+
     /**
     * @brief   初始化表存储
     * @param   database
@@ -212,6 +858,10 @@ public:
     */
     void init(string database, string table) {
         this->filename = dataPos + database + "/" + table + ".dat";
+        this->fsmFilename = dataPos + database + "/" + table + ".fsm";
+        this->fsmHint = 0;
+        this->freePages.clear();
+        this->freeScanned = false;
         this->database = database;
         this->table = table;
     }
@@ -219,180 +869,366 @@ public:
     /**
     * @brief   创建表记录并存储
     * @param   s
-    * @return  true
-    * @return  false
+    * @return  int 记录的rid
     */
-    bool createRecord(string &s) {
-        vector<record> recs;
-        makeRecords(this->database, this->table, recs, s);
-        makeTable(this->database, this->table, recs);
+    int createRecord(string &s) {
+        string row = makeRow(s);
+        if (row == "") {
+            return -1;
+        }
+        int rid = insertTuple(row);
+        flush();
 
-        return true;
+        return rid;
+    }
+
+    /**
+    * @brief   批量创建表记录，全部写入后再写回脏页
+    * @param   s
+    * @param   rids    输出，记录的rid，数据与表结构不符时为-1
+    */
+    void createRecord(vector<string> &s, vector<int> &rids) {
+        rids.assign(s.size(), -1);
+        for (auto i = 0uz; i < s.size(); ++i) {
+            string row = makeRow(s[i]);
+            if (row != "") {
+                rids[i] = insertTuple(row);
+            }
+        }
+        flush();
+    }
+
+    /**
+    * @brief   按页号顺序扫描全部存活的行，已迁移的行以原槽的rid给出，溢出页跳过
+    * @param   f   void(int rid, const rowView &row)
+    */
+    template <typename F>
+    void scanRecords(F f) {
+        if (!filesystem::exists(this->filename)) {
+            return;
+        }
+        int pages = pool().pageCount(this->filename);
+        unordered_set<int> moved;   // 迁移后的新位置，由原槽给出，扫描到时跳过
+        for (auto pass = 0; pass < 2; ++pass) {
+            for (auto pageNo = 0; pageNo < pages; ++pageNo) {
+                char *page = pool().fetch(this->filename, pageNo);
+                if (((heapPage::header *)page)->flags == heapPage::overflowFlag) {
+                    pool().unpin(this->filename, pageNo);
+                    continue;
+                }
+                paxPage pp(page, layout);
+                heapPage hp(page);
+                int n = columnar ? pp.count() : hp.head()->slotNums;
+                for (auto i = 0; i < n; ++i) {
+                    int rid = makeRid(pageNo, i);
+                    bool valid = columnar ? pp.valid(i) : hp.valid(i);
+                    if (!valid) {
+                        continue;
+                    }
+                    bool forwarded = columnar ? pp.forwarded(i) : hp.forwarded(i);
+                    if (pass == 0) {
+                        if (forwarded) {
+                            moved.insert(columnar ? pp.tag(i) : hp.forwardRid(i));
+                        }
+                        continue;
+                    }
+                    if (moved.contains(rid)) {
+                        continue;
+                    }
+                    string row;
+                    if (forwarded) {
+                        readTuple(row, rid);
+                    } else {
+                        row = columnar ? pp.row(i, {}) : string(hp.get(i));
+                    }
+                    if ((uint8_t)row[0] != rowVersion) {
+                        pool().unpin(this->filename, pageNo);
+                        checkRow(row);
+                    }
+                    f(rid, rowView(row, layout));
+                }
+                pool().unpin(this->filename, pageNo);
+            }
+        }
     }
 
     /**
     * @brief   在磁盘上读取表记录
     * @param   s
-    * @param   pos
+    * @param   pos rid
     */
     void readRecord(string &s, int pos) {
         if (!filesystem::exists(this->filename)) {
             cout << "empty table!" << endl;
             return;
         } else {
-            ifstream file(this->filename, ios::in | ios::binary);
-            int offset = pos * (maxRecSize + 1);
-            file.seekg(offset + 1, ios::beg);
-            uint16_t recSize = 0;
-            file.read((char *)&recSize, sizeof(recSize));
-            char _res[recSize];
-            file.seekg(1, ios::cur);
-            file.read(_res, sizeof(_res));
-            s = string(_res, sizeof(_res));
-            file.close();
+            readTuple(s, pos);
         }
     }
-    void readRecord(vector<string> &s, vector<int> &pos) {
+    /**
+    * @brief   批量读取表记录，结果直接指向数据文件的映射（列存表为还原出的行），在下次批量读取前有效
+    *          不在页缓存中的页由后台线程预取，按页号顺序扫描时改为滑动窗口预读（见prefetch.h）
+    * @param   s
+    * @param   pos     rid
+    * @param   filter  仅列存表使用：只读取需要的minipage，且不满足等值条件的行返回空
+    */
+    void readRecord(vector<string_view> &s, vector<int> &pos, const scanFilter &filter = {}) {
         if (!filesystem::exists(this->filename)) {
             cout << "empty table!" << endl;
             return;
-        } else {
-            ifstream file(this->filename, ios::in | ios::binary);
-            file.seekg(0, ios::end);
-            int fileSize = file.tellg();
-            file.seekg(0, ios::beg);
-            char fData[fileSize];
-            file.read(fData, sizeof(fData));
-            file.close();
+        }
+        if (!pool().flush(this->filename) || !fmap.remap(this->filename)) {
+            return;
+        }
+        vector<int> pages;
+        for (auto i : pos) {
+            if (i != -1) {
+                pages.push_back(ridPage(i));
+            }
+        }
+        prefetch.start(this->filename, fmap.data, fmap.size, maxPageSize, std::move(pages));
+        if (columnar) {
+            rowBuf.assign(pos.size(), "");
+            codePage = -1;
             for (auto i = 0uz; i < pos.size(); ++i) {
-                if (pos[i] == -1) {
-                    s[i] = "";
-                    continue;
+                if (pos[i] != -1) {
+                    prefetch.wait(ridPage(pos[i]));
+                    rowBuf[i] = mappedRow(pos[i], filter);
                 }
-                int offset = pos[i] * (maxRecSize + 1);
-                //file.seekg(offset + 1, ios::beg);
-                uint16_t recSize = 0;
-                memcpy((char *)&recSize, fData + offset + 1, sizeof(recSize));
-                //file.read((char *)&recSize, sizeof(recSize));
-                char _res[recSize];
-                //file.seekg(1, ios::cur);
-                memcpy(_res, fData + offset + 2 + sizeof(recSize), sizeof(_res));
-                //file.read(_res, sizeof(_res));
-                s[i] = string(_res, sizeof(_res));
+                s[i] = rowBuf[i];
             }
+            return;
+        }
+        for (auto i = 0uz; i < pos.size(); ++i) {
+            if (pos[i] == -1) {
+                s[i] = string_view();
+                continue;
+            }
+            prefetch.wait(ridPage(pos[i]));
+            s[i] = fmap.tuple(pos[i]);
+            checkRow(s[i]);
         }
     }
 
     /**
     * @brief   在磁盘上更新表记录
-    * @param   pos
+    * @param   pos rid
     * @param   s
+    * @return  true    成功
+    * @return  false   表为空或数据与表结构不符，未作修改
     */
-    void updateRecord(int pos, string s) {
-        vector<record> recs;
-        makeRecords(this->database, this->table, recs, s);
-        if (recs.size() > 1) {
-            cout << "out of bounds!" << endl;
-            return;
-        }
+    bool updateRecord(int pos, string s) {
         if (!filesystem::exists(this->filename)) {
             cout << "empty table!" << endl;
-            return;
-        } else {
-            fstream file(this->filename, ios::in | ios::out | ios::binary);
-
-            int offset = pos * (maxRecSize + 1);
-            file.seekp(offset, ios::beg);
-            recs[0].save(file);
-            file.seekp(ios::beg);
-            file.close();
+            return false;
         }
+        string row = makeRow(s);
+        if (row == "") {
+            return false;
+        }
+        replaceTuple(pos, row);
+        shrink();
+        flush();
+        return true;
     }
+    /**
+    * @brief   批量更新表记录
+    * @param   poses   rid
+    * @param   s       已编码的行（见rowFormat.h，可由setColumn得到），为空则跳过
+    */
     void updateRecord(vector<int> &poses, vector<string> &s) {
         if (!filesystem::exists(this->filename)) {
             cout << "empty table!" << endl;
             return;
         }
-        string profFilename = dataPos + database + "/" + table + ".prof";
-        ifstream profFile(profFilename, ios::in | ios::binary);
-        profFile.seekg(0, ios::end);
-        int profFileSize = profFile.tellg();
-        profFile.seekg(0, ios::beg);
-        char fData[profFileSize];
-        profFile.read(fData, sizeof(fData));
-        profFile.close();
-
-        fstream file(this->filename, ios::in | ios::out | ios::binary);
         for (auto i = 0uz; i < poses.size(); ++i) {
             if (s[i] == "") {
                 continue;
             }
-            vector<record> recs;
-            makeRecords(this->database, this->table, recs, s[i], fData);
-            if (recs.size() > 1) {
-                cout << "out of bounds!" << endl;
-                return;
-            }
+            replaceTuple(poses[i], s[i]);
+        }
+        shrink();
+        flush();
+    }
+
+    /**
+    * @brief   修改行中的一个属性，超过maxRecSize的部分移入溢出页
+    * @param   row 原行
+    * @param   k   属性下标
+    * @param   v   新值
+    * @return  string  新行
+    */
+    string setColumn(string_view row, int k, const string &v) {
+        return layout.set(row, k, v, maxRecSize, [this](string_view t) { return writeOverflow(t); });
+    }
 
-            int offset = poses[i] * (maxRecSize + 1);
-            file.seekp(offset, ios::beg);
-            recs[0].save(file);
+    /**
+    * @brief   以字符串形式读取属性，仅在该属性溢出时读取溢出页
+    * @param   row 行
+    * @param   k   属性下标
+    * @return  string
+    */
+    string getColumn(const rowView &row, int k) {
+        if (!row.external(k)) {
+            return row.get(k);
         }
-        file.close();
+        auto ref = row.ref(k);
+        return readOverflow(ref.first, ref.second);
     }
 
     /**
     * @brief   在磁盘上删除表记录
-    * @param   pos
+    * @param   pos rid
     * @return  true
     * @return  false
     */
     bool deleteRecord(int pos) {
-        fstream _fi(this->filename, ios::in | ios::out | ios::binary);
-        int offset = pos * (maxRecSize + 1);
-        _fi.seekp(offset, ios::beg);
-        char blank[maxRecSize];
-        memset(blank, 0, maxRecSize);
-        _fi.write(blank, maxRecSize);
-        _fi.seekp(ios::beg);
-        _fi.close();
+        eraseTuple(pos);
+        shrink();
+        flush();
 
         return true;
     }
     bool deleteRecord(vector<int> &poses, vector<bool> &erased) {
-        fstream _fi(this->filename, ios::in | ios::out | ios::binary);
         for (auto i = 0uz; i < poses.size(); ++i) {
             if (poses[i] == -1 || erased[i] == false) {
                 continue;
             }
-            int offset = poses[i] * (maxRecSize + 1);
-            _fi.seekp(offset, ios::beg);
-            char blank[maxRecSize];
-            memset(blank, 0, maxRecSize);
-            _fi.write(blank, maxRecSize);
+            eraseTuple(poses[i]);
         }
-        _fi.close();
+        shrink();
+        flush();
 
         return true;
     }
 
+    /**
+    * @brief   数据文件中空闲空间所占比例，页数少于vacuumPages时为0
+    * @return  double
+    */
+    double freeRatio() {
+        int pages = pool().pageCount(this->filename);
+        if (pages < vacuumPages) {
+            return 0;
+        }
+        size_t free = 0;
+        for (auto i = 0; i < pages; ++i) {
+            free += fsmGet(i) * fsmUnit;
+        }
+        return (double)free / ((size_t)pages * maxPageSize);
+    }
+
+    /**
+    * @brief   按给定顺序将存活的行紧密写入新文件.dat.vac（溢出链一并重写），原文件不变，由commitVacuum换入
+    * @param   poses   rid，按主键顺序排列，完成后改写为新rid，已失效的记录置为-1
+    * @return  true    成功
+    * @return  false   写入失败，已删除新文件
+    */
+    bool vacuum(vector<int> &poses) {
+        if (!filesystem::exists(this->filename)) {
+            return true;
+        }
+        if (!flush()) {
+            return false;
+        }
+        dataMgr out = *this;
+        out.filename = this->filename + ".vac";
+        out.fsmFilename = this->fsmFilename + ".vac";
+        out.fsmHint = 0;
+        out.freePages.clear();
+        out.freeScanned = true;
+        pool().discard(out.filename);
+        pool().discard(out.fsmFilename);
+        remove(out.fsmFilename.c_str());
+        fstream file(out.filename, ios::binary | ios::out | ios::trunc);
+        file.close();
+
+        auto spill = [&out](string_view t) { return out.writeOverflow(t); };
+        for (auto &pos : poses) {
+            if (pos == -1) {
+                continue;
+            }
+            string row;
+            readTuple(row, pos);
+            if (row == "") {
+                pos = -1;
+                continue;
+            }
+            rowView rv(row, layout);
+            for (auto k = 0uz; k < layout.size(); ++k) {
+                if (rv.external(k)) {
+                    row = layout.set(row, k, getColumn(rv, k), maxRecSize, spill);
+                    rv = rowView(row, layout);
+                }
+            }
+            pos = out.insertTuple(row);
+        }
+        bool ok = out.flush();
+        pool().discard(out.filename);
+        pool().discard(out.fsmFilename);
+        if (!ok) {
+            abortVacuum();
+        }
+        return ok;
+    }
+
+    /**
+    * @brief   以vacuum写入的新文件替换原数据文件，rename为换入的提交点
+    * @return  true    成功
+    * @return  false   rename失败，原文件不变，已删除新文件
+    */
+    bool commitVacuum() {
+        string vac = this->filename + ".vac", fsmVac = this->fsmFilename + ".vac";
+        if (!filesystem::exists(this->filename)) {
+            return true;
+        }
+        pool().discard(this->filename);
+        pool().discard(this->fsmFilename);
+        fmap.unmap();
+        fsmHint = 0;
+        freePages.clear();
+        freeScanned = false;
+        if (rename(vac.c_str(), this->filename.c_str()) != 0) {
+            cout << "Vacuum failed: " << strerror(errno) << endl;
+            abortVacuum();
+            return false;
+        }
+        if (rename(fsmVac.c_str(), this->fsmFilename.c_str()) != 0) {
+            remove(this->fsmFilename.c_str());
+        }
+        return true;
+    }
+
+    /**
+    * @brief   删除vacuum写入的新文件
+    */
+    void abortVacuum() {
+        remove((this->filename + ".vac").c_str());
+        remove((this->fsmFilename + ".vac").c_str());
+    }
+
+    /**
+    * @brief   将缓冲池中该表的脏页写回磁盘
+    * @return  true    成功
+    * @return  false   写入失败，见bufferPool::flush
+    */
+    bool flush() {
+        bool ok = pool().flush(this->filename);
+        return pool().flush(this->fsmFilename) && ok;
+    }
+
     /**
     * @brief   无条件初始化磁盘数据
     */
     void profInit() {
-        string prof = dataPos + database + "/" + table + ".prof";
         if (!filesystem::exists(filename)) {
+            pool().discard(filename);
+            pool().discard(fsmFilename);
+            remove(fsmFilename.c_str());
+            fsmHint = 0;
+            freePages.clear();
+            freeScanned = false;
             fstream file(filename, ios::binary | ios::out);
-            file.seekp(maxPageSize - 1);
-            file.write("", 1);
-
-            fstream _file(prof, ios::binary | ios::out | ios::in);
-            _file.seekp(maxPropSize, ios::beg);
-            int fptr = 0;
-            _file.write((char *)&fptr, 4);
-            _file.seekp(ios::beg);
-            _file.close();
-            file.seekp(ios::beg);
             file.close();
         }
     }
@@ -405,160 +1241,522 @@ public:
     }
 private:
     /**
-    * @brief   在内存中实例化一个记录
-    * @param   database
-    * @param   tablename
-    * @param   recs
+    * @brief   读取rid处的tuple，已迁移的tuple读取其新位置
     * @param   s
+    * @param   rid
     */
-    void makeRecords(string const database, string const tablename, vector<record> &recs, string s) {
-        vector<string> _split;
-        str_split(s, _split, regex("((\"\\s*,\\s*\")|(\"\\s*,\\s*)|(\\s*,\\s*\")|(\\s*,\\s*))"));
-        string filename = dataPos + database + "/" + tablename + ".prof";
-        ifstream file(filename, ios::in | ios::binary);
-        file.seekg(8, ios::beg);
-        char _r[4] = {};
-        file.read(_r, 4);
-        int propNums = 0;
-        memcpy(&propNums, _r, 4);
-        if (propNums != (int)_split.size()) {
-            cout << "data mismatch!" << endl;
-            file.close();
+    void readTuple(string &s, int rid) {
+        int pageNo = ridPage(rid);
+        if (columnar) {
+            paxPage pp(pool().fetch(this->filename, pageNo), layout);
+            int slot = ridSlot(rid), to = -1;
+            s = "";
+            if (pp.valid(slot)) {
+                if (pp.forwarded(slot)) {
+                    to = pp.tag(slot);
+                } else {
+                    s = pp.row(slot, {});
+                }
+            }
+            pool().unpin(this->filename, pageNo);
+            if (to >= 0) {
+                readTuple(s, to);
+            }
             return;
         }
-        for (auto &i : _split) {
-            char _signal = 0;
-            file.read(&_signal, 1);
-            char _type = (_signal == 0 ? 's' : 'i');
-            i.insert(i.begin(), _type);
+        heapPage hp(pool().fetch(this->filename, pageNo));
+        int slot = ridSlot(rid);
+        if (!hp.valid(slot)) {
+            s = "";
+        } else if (hp.forwarded(slot)) {
+            int to = hp.forwardRid(slot);
+            pool().unpin(this->filename, pageNo);
+            readTuple(s, to);
+            return;
+        } else {
+            s = hp.get(slot);
         }
-        file.close();
-        if (_split.front()[1] == '\"')
-            _split.front().erase(1, 1);
-        if (_split.back().back() == '\"')
-            _split.back().pop_back();
+        pool().unpin(this->filename, pageNo);
+        checkRow(s);
+    }
+
+    /**
+    * @brief   检查行的版本号，与rowVersion不符的行不按当前格式解释
+    * @param   row
+    * @throw   ioError 版本号不符
+    */
+    void checkRow(string_view row) const {
+        if (!row.empty() && (uint8_t)row[0] != rowVersion) {
+            throw ioError("Unsupported row format " + to_string((uint8_t)row[0]) + " in " + this->filename);
+        }
+    }
+
+    /**
+    * @brief   按空闲空间映射表将tuple插入有足够空间的页，均不足时追加新页
+    * @param   t
+    * @return  int rid
+    */
+    int insertTuple(string_view t) {
+        if (columnar) {
+            return paxInsert(t);
+        }
+        int pages = pool().pageCount(this->filename);
+        int pageNo = fsmSearch(heapPage::footprint(t.size()) + sizeof(heapPage::slot));
+        heapPage hp(pool().fetch(this->filename, pageNo));
+        int slot = hp.insert(t);
+        if (slot < 0) {
+            pool().unpin(this->filename, pageNo);
+            pageNo = pages;
+            hp = heapPage(pool().fetch(this->filename, pageNo));
+            slot = hp.insert(t);
+        }
+        fsmSet(pageNo, hp.reclaimable());
+        pool().unpin(this->filename, pageNo, true);
+        return makeRid(pageNo, slot);
+    }
 
-        auto beg = 0uz;
-        int cnts = 0;
-        while (beg < _split.size()) {
-            record rec;
-            beg = rec.fill(_split);
-            recs.push_back(rec);
-            cnts++;
-            if (beg < _split.size()) {
-                cout << "data out of bounds!" << endl;
-                remove((dataPos + database + "/" + tablename + ".dat").c_str());
-                remove((dataPos + database + "/" + tablename + ".ind").c_str());
-                remove((dataPos + database + "/" + tablename + ".prof").c_str());
-                exit(1);
+    /**
+    * @brief   更新rid处的tuple，页内空间不足时迁移到其他页并在原槽中留下新位置
+    * @param   rid
+    * @param   t
+    */
+    void updateTuple(int rid, string_view t) {
+        if (columnar) {
+            paxUpdate(rid, t);
+            return;
+        }
+        int pageNo = ridPage(rid);
+        int slot = ridSlot(rid);
+        heapPage hp(pool().fetch(this->filename, pageNo));
+        if (!hp.valid(slot)) {
+            pool().unpin(this->filename, pageNo);
+            return;
+        }
+        if (hp.forwarded(slot)) {
+            int to = hp.forwardRid(slot);
+            heapPage tp(pool().fetch(this->filename, ridPage(to)));
+            bool done = tp.update(ridSlot(to), t);
+            if (!done) {
+                tp.erase(ridSlot(to));
+            }
+            fsmSet(ridPage(to), tp.reclaimable());
+            pool().unpin(this->filename, ridPage(to), true);
+            if (!done) {
+                hp.forward(slot, insertTuple(t));
             }
+        } else if (!hp.update(slot, t)) {
+            hp.forward(slot, insertTuple(t));
         }
-        recs.front().make_head(cnts);
+        fsmSet(pageNo, hp.reclaimable());
+        pool().unpin(this->filename, pageNo, true);
     }
-    void makeRecords(string const database, string const tablename, vector<record> &recs, string s, char* fData) {
-        vector<string> _split;
-        str_split(s, _split, regex("((\"\\s*,\\s*\")|(\"\\s*,\\s*)|(\\s*,\\s*\")|(\\s*,\\s*))"));
-        int filePtr = 0;
-        char _r[4] = {};
-        filePtr += 8;
-        memcpy(_r, fData + filePtr, 4);
-        filePtr += 4;
-        int propNums = 0;
-        memcpy(&propNums, _r, 4);
-        if (propNums != (int)_split.size()) {
-            cout << "data mismatch!" << endl;
+
+    /**
+    * @brief   以新行替换rid处的行，释放不再被引用的溢出链
+    * @param   rid
+    * @param   row
+    */
+    void replaceTuple(int rid, string_view row) {
+        string old;
+        readTuple(old, rid);
+        if (old == "") {
             return;
         }
-        for (auto &i : _split) {
-            char _signal = 0;
-            memcpy(&_signal, fData + filePtr, 1);
-            filePtr += 1;
-            char _type = (_signal == 0 ? 's' : 'i');
-            i.insert(i.begin(), _type);
+        updateTuple(rid, row);
+        auto keep = layout.refs(row);
+        for (auto &i : layout.refs(old)) {
+            if (find(keep.begin(), keep.end(), i) == keep.end()) {
+                freeOverflow(i.first);
+            }
         }
-        if (_split.front()[1] == '\"')
-            _split.front().erase(1, 1);
-        if (_split.back().back() == '\"')
-            _split.back().pop_back();
+    }
 
-        auto beg = 0uz;
-        int cnts = 0;
-        while (beg < _split.size()) {
-            record rec;
-            beg = rec.fill(_split);
-            recs.push_back(rec);
-            cnts++;
-            if (beg < _split.size()) {
-                cout << "data out of bounds!" << endl;
-                remove((dataPos + database + "/" + tablename + ".dat").c_str());
-                remove((dataPos + database + "/" + tablename + ".ind").c_str());
-                remove((dataPos + database + "/" + tablename + ".prof").c_str());
-                exit(1);
+    /**
+    * @brief   删除rid处的tuple，已迁移的tuple一并删除其新位置，并释放其溢出链
+    * @param   rid
+    */
+    void eraseTuple(int rid) {
+        if (columnar) {
+            paxErase(rid);
+            return;
+        }
+        int pageNo = ridPage(rid);
+        int slot = ridSlot(rid);
+        heapPage hp(pool().fetch(this->filename, pageNo));
+        vector<pair<int, int>> refs;
+        if (hp.valid(slot)) {
+            if (hp.forwarded(slot)) {
+                eraseTuple(hp.forwardRid(slot));
+            } else {
+                refs = layout.refs(hp.get(slot));
             }
+            hp.erase(slot);
+            fsmSet(pageNo, hp.reclaimable());
+        }
+        pool().unpin(this->filename, pageNo, true);
+        for (auto &i : refs) {
+            freeOverflow(i.first);
         }
-        recs.front().make_head(cnts);
     }
 
     /**
-    * @brief   将内存中的记录数据存储到磁盘
-    * @param   database
-    * @param   tablename
-    * @param   recs
+    * @brief   将行插入有足够空间的PAX页，均不足时追加新页
+    * @param   t   行
+    * @return  int rid，行超过一页时为-1
     */
-    void makeTable(string const database, string const tablename, vector<record> &recs) {
-        string filename = dataPos + database + "/" + tablename + ".dat";
-        if (!filesystem::exists(filename)) {
-            fstream file(filename, ios::binary | ios::out);
-            int cnts = 0;
-            int fptr = 0;
-            for (auto i = 0uz; i < recs.size(); ++i) {
-                if (recs.size() > 1 && i != recs.size() - 1) {
-                    recs[i].data[3] = cnts + 1;
+    int paxInsert(string_view t) {
+        int pages = pool().pageCount(this->filename);
+        int pageNo = fsmSearch(t.size() + 4);
+        while (true) {
+            char *page = pool().fetch(this->filename, pageNo);
+            paxPage pp(page, layout);
+            int slot = -1;
+            if (pp.isPax() || heapPage(page).empty()) {
+                auto c = pp.load();
+                slot = c.add();
+                if (slot >= 0) {
+                    c.set(slot, t, layout);
+                    if (!pp.store(c)) {
+                        slot = -1;
+                    }
                 }
-                recs[i].save(file);
-                cnts++;
-                fptr = file.tellp();
-                file.seekp(maxPageSize * cnts - 1);
-                file.write("", 1);
-            }
-            fstream _file(dataPos + database + "/" + tablename + ".prof", ios::binary | ios::out | ios::in);
-            _file.seekp(maxPropSize, ios::beg);
-            _file.write((char *)&fptr, 4);
-            _file.seekp(ios::beg);
-            _file.close();
-            file.seekp(ios::beg);
-            file.close();
+            }
+            if (slot >= 0) {
+                fsmSet(pageNo, pp.freeSpace());
+                pool().unpin(this->filename, pageNo, true);
+                return makeRid(pageNo, slot);
+            }
+            pool().unpin(this->filename, pageNo);
+            if (pageNo >= pages) {
+                return -1;
+            }
+            pageNo = fsmSearch(t.size() + 4, pageNo + 1); // 编码后的页可能增长超过行长，继续向后查找
+        }
+    }
+    /**
+    * @brief   改写PAX页中的一个槽
+    * @param   rid
+    * @param   t       新行，tag不为liveTag时忽略
+    * @param   tag     liveTag写入行，emptyTag删除，否则写为指向该rid的迁移记录
+    * @return  true    成功
+    * @return  false   页内空间不足，页保持不变
+    */
+    bool paxWrite(int rid, string_view t, int tag) {
+        int pageNo = ridPage(rid);
+        paxPage pp(pool().fetch(this->filename, pageNo), layout);
+        auto c = pp.load();
+        if (tag == paxPage::liveTag) {
+            c.set(ridSlot(rid), t, layout);
         } else {
-            fstream file(filename, ios::in | ios::out | ios::binary);
-            fstream _file(dataPos + database + "/" + tablename + ".prof", ios::in | ios::out | ios::binary);
-            int rptr = 0;
-            char _r[4] = {};
-            _file.seekg(maxPropSize, ios::beg);
-            _file.read(_r, 4);
-            _file.seekg(ios::beg);
-            memcpy(&rptr, _r, 4);
-            int cnts = rptr / maxPageSize;
-            rptr = rptr == 0 ? -1 : rptr;
-            int fptr = 0;
-            file.seekp(rptr + 1, ios::beg);
-            for (auto i = 0uz; i < recs.size(); ++i) {
-                if (recs.size() > 1 && i != recs.size() - 1) {
-                    recs[i].data[3] = cnts + 1;
+            c.clear(ridSlot(rid), tag, layout);
+        }
+        bool done = pp.store(c);
+        if (done) {
+            fsmSet(pageNo, pp.freeSpace());
+        }
+        pool().unpin(this->filename, pageNo, done);
+        return done;
+    }
+    /**
+    * @brief   PAX页中槽的目录项
+    * @param   rid
+    * @return  int 见paxPage::tag，槽不存在时为emptyTag
+    */
+    int paxTag(int rid) {
+        paxPage pp(pool().fetch(this->filename, ridPage(rid)), layout);
+        int tag = pp.valid(ridSlot(rid)) ? pp.tag(ridSlot(rid)) : paxPage::emptyTag;
+        pool().unpin(this->filename, ridPage(rid));
+        return tag;
+    }
+    /**
+    * @brief   更新PAX页中的行，页内空间不足时迁移到其他页并在原槽中留下新位置
+    * @param   rid
+    * @param   t
+    */
+    void paxUpdate(int rid, string_view t) {
+        int tag = paxTag(rid);
+        if (tag == paxPage::emptyTag) {
+            return;
+        }
+        if (tag >= 0 && paxWrite(tag, t, paxPage::liveTag)) {
+            return;
+        }
+        if (tag < 0 && paxWrite(rid, t, paxPage::liveTag)) {
+            return;
+        }
+        int to = paxInsert(t);
+        if (to < 0) {
+            return;
+        }
+        if (tag >= 0) {
+            paxWrite(tag, "", paxPage::emptyTag);
+        }
+        paxWrite(rid, "", to);
+    }
+    /**
+    * @brief   删除PAX页中的行，已迁移的行一并删除其新位置，并释放其溢出链
+    * @param   rid
+    */
+    void paxErase(int rid) {
+        int tag = paxTag(rid);
+        if (tag == paxPage::emptyTag) {
+            return;
+        }
+        vector<pair<int, int>> refs;
+        if (tag >= 0) {
+            paxErase(tag);
+        } else {
+            string row;
+            readTuple(row, rid);
+            refs = layout.refs(row);
+        }
+        paxWrite(rid, "", paxPage::emptyTag);
+        for (auto &i : refs) {
+            freeOverflow(i.first);
+        }
+    }
+    /**
+    * @brief   从映射中还原列存表的行，只读取需要的属性
+    *          等值条件先在页内判断，每页只在字典中查找一次，之后逐行比较编码
+    * @param   rid
+    * @param   filter
+    * @return  string  行不存在或不满足等值条件时为空
+    */
+    string mappedRow(int rid, const scanFilter &filter) {
+        const char *page = fmap.page(ridPage(rid));
+        if (page == nullptr) {
+            return "";
+        }
+        paxPage pp(const_cast<char *>(page), layout); // 只读访问
+        int slot = ridSlot(rid);
+        if (!pp.valid(slot)) {
+            return "";
+        }
+        if (pp.forwarded(slot)) {
+            return mappedRow(pp.tag(slot), filter);
+        }
+        if (!filter.equals.empty() && ridPage(rid) != codePage) {
+            codePage = ridPage(rid);
+            filterCodes.clear();
+            for (auto &[a, v] : filter.equals) {
+                filterCodes.push_back(pp.isDict(a) ? pp.findCode(a, v) : -1);
+            }
+        }
+        for (auto k = 0uz; k < filter.equals.size(); ++k) {
+            if (!pp.mayEqual(filter.equals[k].first, slot, filter.equals[k].second, filterCodes[k])) {
+                return "";
+            }
+        }
+        return pp.row(slot, filter.cols);
+    }
+
+    /**
+    * @brief   将string写入新的溢出链
+    * @param   t
+    * @return  string  溢出引用（首页页号及长度）
+    */
+    string writeOverflow(string_view t) {
+        int first = -1, prev = -1;
+        for (auto beg = 0uz; beg < t.size(); beg += overflowPage::capacity) {
+            int pageNo = allocPage();
+            overflowPage op(pool().fetch(this->filename, pageNo));
+            op.put(t.substr(beg, overflowPage::capacity), -1);
+            pool().unpin(this->filename, pageNo, true);
+            fsmSet(pageNo, 0);
+            if (prev == -1) {
+                first = pageNo;
+            } else {
+                overflowPage pp(pool().fetch(this->filename, prev));
+                pp.setNext(pageNo);
+                pool().unpin(this->filename, prev, true);
+            }
+            prev = pageNo;
+        }
+        int len = t.size();
+        string ref(refSize, 0);
+        memcpy(ref.data(), &first, 4);
+        memcpy(ref.data() + 4, &len, 4);
+        return ref;
+    }
+    /**
+    * @brief   读取溢出链中的string
+    * @param   pageNo  首页页号
+    * @param   len     长度
+    * @return  string
+    */
+    string readOverflow(int pageNo, int len) {
+        string res;
+        res.reserve(len);
+        while (pageNo >= 0 && (int)res.size() < len) {
+            overflowPage op(pool().fetch(this->filename, pageNo));
+            int next = -1;
+            if (op.head()->flags == heapPage::overflowFlag) {
+                res.append(op.get());
+                next = op.next();
+            }
+            pool().unpin(this->filename, pageNo);
+            pageNo = next;
+        }
+        return res;
+    }
+    /**
+    * @brief   释放溢出链，其页重新作为空的数据页使用
+    * @param   pageNo  首页页号
+    */
+    void freeOverflow(int pageNo) {
+        while (pageNo >= 0) {
+            char *p = pool().fetch(this->filename, pageNo);
+            overflowPage op(p);
+            if (op.head()->flags != heapPage::overflowFlag) {
+                pool().unpin(this->filename, pageNo);
+                break;
+            }
+            int next = op.next();
+            memset(p, 0, maxPageSize);
+            heapPage hp(p);
+            fsmSet(pageNo, hp.reclaimable());
+            pool().unpin(this->filename, pageNo, true);
+            freePages.push_back(pageNo);
+            pageNo = next;
+        }
+    }
+    /**
+    * @brief   为溢出链分配一页，优先复用仍为空的页，首次分配时从空闲空间映射表中收集空页
+    * @return  int 页号
+    */
+    int allocPage() {
+        int pages = pool().pageCount(this->filename);
+        if (!freeScanned) {
+            freeScanned = true;
+            for (auto i = pages - 1; i >= 0; --i) {
+                if (fsmGet(i) == 254) {
+                    freePages.push_back(i);
                 }
-                recs[i].save(file);
-                cnts++;
-                fptr = file.tellp();
-                file.seekp(maxPageSize * cnts - 1);
-                file.write("", 1);
-            }
-            _file.seekp(maxPropSize, ios::beg);
-            _file.write((char *)&fptr, 4);
-            _file.seekp(ios::beg);
-            _file.close();
-            file.seekp(ios::beg);
-            file.close();
+            }
+        }
+        while (!freePages.empty()) {
+            int pageNo = freePages.back();
+            freePages.pop_back();
+            if (pageNo >= pages) {
+                continue;
+            }
+            heapPage hp(pool().fetch(this->filename, pageNo));
+            bool empty = hp.empty();
+            pool().unpin(this->filename, pageNo);
+            if (empty) {
+                return pageNo;
+            }
         }
+        return pages;
+    }
+
+    /**
+    * @brief   读取某页的空闲等级，未知时读取数据页计算
+    * @param   pageNo
+    * @return  int 可用空间/fsmUnit
+    */
+    int fsmGet(int pageNo) {
+        int fsmPage = pageNo / maxPageSize;
+        char *p = pool().fetch(this->fsmFilename, fsmPage);
+        int v = (uint8_t)p[pageNo % maxPageSize];
+        pool().unpin(this->fsmFilename, fsmPage);
+        if (v == 0) {
+            char *page = pool().fetch(this->filename, pageNo);
+            heapPage hp(page);
+            paxPage pp(page, layout);
+            v = fsmSet(pageNo, pp.isPax() ? pp.freeSpace() : hp.reclaimable());
+            pool().unpin(this->filename, pageNo);
+        }
+        return v - 1;
+    }
+    /**
+    * @brief   记录某页的可用空间
+    * @param   pageNo
+    * @param   free    可用空间
+    * @return  int     写入的值
+    */
+    int fsmSet(int pageNo, size_t free) {
+        int v = min(free / fsmUnit, (size_t)254) + 1;
+        int fsmPage = pageNo / maxPageSize;
+        char *p = pool().fetch(this->fsmFilename, fsmPage);
+        auto &e = p[pageNo % maxPageSize];
+        bool changed = (uint8_t)e != v;
+        if (changed && (uint8_t)e != 0 && v > (uint8_t)e) { // 空间增加，回退查找起点
+            fsmHint = min(fsmHint, pageNo);
+        }
+        e = v;
+        pool().unpin(this->fsmFilename, fsmPage, changed);
+        return v;
+    }
+    /**
+    * @brief   查找可用空间不小于need的页
+    * @param   need
+    * @param   from    查找起始页号
+    * @return  int 页号，均不足时为新页页号
+    */
+    int fsmSearch(size_t need, int from = 0) {
+        int pages = pool().pageCount(this->filename);
+        int level = (need + fsmUnit - 1) / fsmUnit;
+        for (auto i = max(fsmHint, from); i < pages; ++i) {
+            int free = fsmGet(i);
+            if (free >= level) {
+                return i;
+            }
+            if (i == fsmHint && free == 0) { // 起点之前的页均已满，任何tuple都无法放入
+                fsmHint++;
+            }
+        }
+        return pages;
+    }
+
+    /**
+    * @brief   截去文件末尾的空页
+    */
+    void shrink() {
+        int pages = pool().pageCount(this->filename);
+        int n = pages;
+        while (n > 0) {
+            heapPage hp(pool().fetch(this->filename, n - 1));
+            bool empty = hp.empty();
+            pool().unpin(this->filename, n - 1);
+            if (!empty) {
+                break;
+            }
+            n--;
+        }
+        if (n == pages) {
+            return;
+        }
+        pool().truncate(this->filename, n);
+        for (auto i = n; i < pages; ++i) {
+            int fsmPage = i / maxPageSize;
+            char *p = pool().fetch(this->fsmFilename, fsmPage);
+            p[i % maxPageSize] = 0;
+            pool().unpin(this->fsmFilename, fsmPage, true);
+        }
+        fsmHint = min(fsmHint, n);
+    }
+
+    /**
+    * @brief   将一行数据编码，超过maxRecSize的部分移入溢出页
+    * @param   s   以逗号分隔的属性值
+    * @return  string  编码后的行，数据与表结构不符时为空
+    */
+    string makeRow(string s) {
+        static const regex sep("((\"\\s*,\\s*\")|(\"\\s*,\\s*)|(\\s*,\\s*\")|(\\s*,\\s*))");
+        vector<string> _split;
+        str_split(s, _split, sep);
+        if (layout.size() != _split.size()) {
+            cout << "data mismatch!" << endl;
+            return "";
+        }
+        if (_split.front()[0] == '\"')
+            _split.front().erase(0, 1);
+        if (_split.back().back() == '\"')
+            _split.back().pop_back();
+
+        return layout.encode(_split, maxRecSize, [this](string_view t) { return writeOverflow(t); });
     }
 
 };
-}
\ No newline at end of file
+}
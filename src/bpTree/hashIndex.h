@@ -0,0 +1,366 @@
+/**
+ * @file        hashIndex.h
+ * @brief       线性hash索引
+ *              只支持等值查找，存放于table.<索引名>.hash，页经页缓冲池读写：
+ *                  第0页：元数据（见hashMeta），其后为各目录页的页号
+ *                  目录页：xxxx ...  各桶首页的页号，每页maxPageSize/4个桶
+ *                  桶页：xxxx xxxx  溢出页号 项数，其后为 xxxx xxxx  关键字的hash值 rid
+ *              桶中只存hash值，hash值相同的不同关键字由调用方按原条件再次过滤
+ *              线性hash：
+ *                  桶数为 2^level + next，关键字的桶号为 h mod 2^level，小于next时为 h mod 2^(level+1)
+ *                  索引项数超过 hashFill * 桶数 * 每页项数 时分裂第next个桶，每次只分裂一个桶，扩容代价分摊到各次插入
+ *                  删除不合并桶，空出的位置由之后的插入复用
+ * @author      hjb
+ * @version     1.0
+ * @date        2023-12-14
+ * @copyright   Copyright (c) 2023
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "bufferPool.h"
+#include "dataMgr.h"
+
+namespace bpT {
+using namespace std;
+
+static const uint32_t hashMagic = 0x49485342; // "BSHI"
+static const double hashFill = 0.75;          // 触发分裂的平均装载率
+
+/**
+* @brief   hash索引的元数据，位于第0页
+*/
+struct hashMeta {
+    uint32_t magic = hashMagic;
+    int32_t level = 0;      // 本轮分裂前的桶数为2^level
+    int32_t next = 0;       // 下一个分裂的桶
+    int32_t count = 0;      // 索引项个数
+    int32_t freeList = -1;  // 空闲页链表
+    int32_t dirs = 0;       // 目录页个数
+};
+
+/**
+* @brief   线性hash索引
+*/
+class hashIndex {
+private:
+    static constexpr int perDir = maxPageSize / 4;      // 每个目录页的桶数
+    static constexpr int perPage = (maxPageSize - 8) / 8;   // 每个桶页的项数
+    static constexpr int maxDirs = (maxPageSize - sizeof(hashMeta)) / 4;
+
+    /**
+    * @brief   pin住的页，析构时unpin
+    */
+    struct pinned {
+        const string &file;
+        int pageNo;
+        char *d;
+        bool dirty = false;
+
+        pinned(const string &file, int pageNo) : file(file), pageNo(pageNo), d(pool().fetch(file, pageNo)) {}
+        pinned(const pinned &) = delete;
+        ~pinned() noexcept {
+            pool().unpin(file, pageNo, dirty);
+        }
+        int32_t *ints() {
+            return (int32_t *)d;
+        }
+        // 桶页
+        int32_t &next() {
+            return ints()[0];
+        }
+        int32_t &size() {
+            return ints()[1];
+        }
+        uint32_t &hash(int i) {
+            return ((uint32_t *)d)[2 + 2 * i];
+        }
+        int32_t &rid(int i) {
+            return ints()[3 + 2 * i];
+        }
+    };
+
+    string filename = "";   // 索引文件路径
+    hashMeta meta;          // 元数据页的副本，每次操作前从缓冲池读取
+
+    /**
+    * @brief   读取元数据页，文件不存在或无法识别时初始化为只有一个桶的空索引
+    */
+    void loadMeta() {
+        {
+            pinned p(filename, 0);
+            memcpy(&meta, p.d, sizeof(meta));
+        }
+        if (meta.magic != hashMagic || meta.dirs <= 0 || pool().pageCount(filename) <= 1) {
+            format(1);
+        }
+    }
+    void storeMeta() {
+        pinned p(filename, 0);
+        memcpy(p.d, &meta, sizeof(meta));
+        p.dirty = true;
+    }
+
+    /**
+    * @brief   清空索引文件，建立n个空桶
+    * @param   n
+    */
+    void format(int n) {
+        pool().truncate(filename, 0);
+        meta = hashMeta {};
+        for (; (2 << meta.level) <= n; ++meta.level) {
+        }
+        meta.next = n - (1 << meta.level);
+        storeMeta();
+        for (auto b = 0; b < n; ++b) {
+            addBucket(b);
+        }
+        storeMeta();
+    }
+
+    /**
+    * @brief   分配一页并清零，优先复用空闲页
+    * @return  int 页号
+    */
+    int allocPage() {
+        int pageNo = meta.freeList != -1 ? meta.freeList : pool().pageCount(filename);
+        pinned p(filename, pageNo);
+        if (pageNo == meta.freeList) {
+            meta.freeList = p.next();
+        }
+        memset(p.d, 0, maxPageSize);
+        p.next() = -1;
+        p.dirty = true;
+        return pageNo;
+    }
+    void freePage(int pageNo) {
+        pinned p(filename, pageNo);
+        p.next() = meta.freeList;
+        p.size() = 0;
+        p.dirty = true;
+        meta.freeList = pageNo;
+    }
+
+    /**
+    * @brief   桶首页在目录中的位置
+    * @param   b       桶号
+    * @param   pageNo  输出，目录页号
+    * @return  int     目录页内下标
+    */
+    int locate(int b, int &pageNo) {
+        pinned m(filename, 0);
+        pageNo = ((int32_t *)(m.d + sizeof(hashMeta)))[b / perDir];
+        return b % perDir;
+    }
+    int head(int b) {
+        int dirNo = 0, i = locate(b, dirNo);
+        pinned d(filename, dirNo);
+        return d.ints()[i];
+    }
+    void setHead(int b, int pageNo) {
+        int dirNo = 0, i = locate(b, dirNo);
+        pinned d(filename, dirNo);
+        d.ints()[i] = pageNo;
+        d.dirty = true;
+    }
+
+    /**
+    * @brief   新建第b个桶，桶数为目录页容量的整数倍时先分配目录页
+    * @param   b
+    */
+    void addBucket(int b) {
+        if (b % perDir == 0) {
+            int dirNo = allocPage();
+            pinned m(filename, 0);
+            ((int32_t *)(m.d + sizeof(hashMeta)))[meta.dirs++] = dirNo;
+            m.dirty = true;
+        }
+        setHead(b, allocPage());
+    }
+
+    int buckets() const {
+        return (1 << meta.level) + meta.next;
+    }
+    int bucketOf(uint32_t h) const {
+        uint32_t b = h & ((1u << meta.level) - 1);
+        return b < (uint32_t)meta.next ? h & ((2u << meta.level) - 1) : b;
+    }
+
+    /**
+    * @brief   将索引项放入其所在的桶，桶中各页已满时在链首加入溢出页
+    * @param   h
+    * @param   rid
+    */
+    void place(uint32_t h, int rid) {
+        int b = bucketOf(h), first = head(b);
+        for (int pageNo = first; pageNo != -1;) {
+            pinned p(filename, pageNo);
+            if (p.size() < perPage) {
+                p.hash(p.size()) = h;
+                p.rid(p.size()) = rid;
+                p.size()++;
+                p.dirty = true;
+                return;
+            }
+            pageNo = p.next();
+        }
+        int pageNo = allocPage();
+        pinned p(filename, pageNo);
+        p.next() = first;
+        p.hash(0) = h;
+        p.rid(0) = rid;
+        p.size() = 1;
+        p.dirty = true;
+        setHead(b, pageNo);
+    }
+
+    /**
+    * @brief   分裂第next个桶，其中的索引项按 h mod 2^(level+1) 分到原桶与新桶
+    */
+    void split() {
+        if ((buckets() + perDir - 1) / perDir >= maxDirs) {
+            return;
+        }
+        int b = meta.next;
+        vector<pair<uint32_t, int>> es;
+        int first = head(b);
+        for (int pageNo = first; pageNo != -1;) {
+            int next = -1;
+            {
+                pinned p(filename, pageNo);
+                for (auto i = 0; i < p.size(); ++i) {
+                    es.emplace_back(p.hash(i), p.rid(i));
+                }
+                next = p.next();
+                if (pageNo == first) {
+                    p.next() = -1;
+                    p.size() = 0;
+                    p.dirty = true;
+                }
+            }
+            if (pageNo != first) {
+                freePage(pageNo);
+            }
+            pageNo = next;
+        }
+        addBucket(buckets());
+        if (++meta.next == (1 << meta.level)) {
+            meta.level++;
+            meta.next = 0;
+        }
+        for (auto &e : es) {
+            place(e.first, e.second);
+        }
+    }
+
+public:
+    /**
+    * @brief   关键字的hash值（FNV-1a，再经fmix32混合低位）
+    * @param   k
+    * @return  uint32_t
+    */
+    static uint32_t hashOf(string_view k) {
+        uint32_t h = 2166136261u;
+        for (auto c : k) {
+            h = (h ^ (uint8_t)c) * 16777619u;
+        }
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    void init(const string &filename) {
+        this->filename = filename;
+    }
+
+    /**
+    * @brief   加入索引项，装载率超过hashFill时分裂一个桶
+    * @param   h
+    * @param   rid
+    */
+    void insert(uint32_t h, int rid) {
+        loadMeta();
+        place(h, rid);
+        meta.count++;
+        if (meta.count > hashFill * perPage * buckets()) {
+            split();
+        }
+        storeMeta();
+    }
+
+    /**
+    * @brief   删除索引项，以所在页的最后一项填补空位
+    * @param   h
+    * @param   rid
+    */
+    void erase(uint32_t h, int rid) {
+        loadMeta();
+        for (int pageNo = head(bucketOf(h)); pageNo != -1;) {
+            pinned p(filename, pageNo);
+            for (auto i = 0; i < p.size(); ++i) {
+                if (p.hash(i) == h && p.rid(i) == rid) {
+                    int last = --p.size();
+                    p.hash(i) = p.hash(last);
+                    p.rid(i) = p.rid(last);
+                    p.dirty = true;
+                    meta.count--;
+                    storeMeta();
+                    return;
+                }
+            }
+            pageNo = p.next();
+        }
+    }
+
+    /**
+    * @brief   查找hash值为h的全部rid
+    * @param   h
+    * @param   rids    输出
+    */
+    void find(uint32_t h, vector<int> &rids) {
+        loadMeta();
+        for (int pageNo = head(bucketOf(h)); pageNo != -1;) {
+            pinned p(filename, pageNo);
+            for (auto i = 0; i < p.size(); ++i) {
+                if (p.hash(i) == h) {
+                    rids.push_back(p.rid(i));
+                }
+            }
+            pageNo = p.next();
+        }
+    }
+
+    /**
+    * @brief   丢弃原有索引项，按项数一次建好所需的桶后批量放入
+    * @param   es  hash值及rid
+    */
+    void build(const vector<pair<uint32_t, int>> &es) {
+        int n = es.size() / (hashFill * perPage) + 1;
+        format(min(n, (maxDirs - 1) * perDir));
+        for (auto &e : es) {
+            place(e.first, e.second);
+        }
+        meta.count = es.size();
+        storeMeta();
+    }
+
+    /**
+    * @brief   将索引的脏页写回磁盘
+    * @return  true    成功
+    * @return  false   写入失败，见bufferPool::flush
+    */
+    bool save() {
+        return pool().flush(filename);
+    }
+};
+}
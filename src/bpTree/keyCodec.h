@@ -0,0 +1,182 @@
+/**
+ * @file        keyCodec.h
+ * @brief       多属性关键字的保序编码
+ *              组合主键及二级索引以各属性的编码依次拼接为string关键字，按字节比较的结果与按属性依次比较一致：
+ *                  int属性：xxxx  符号位取反后的大端序
+ *                  string属性：xxxxxx 0  属性值及结束符，'\0'小于其他字符，故较短的值排在以其为前缀的值之前
+ *              前导属性上的等值条件确定关键字前缀，其后一个属性上的比较条件确定前缀内的区间，
+ *              一次自根向下的查找即可定位，沿叶子链表扫描至区间结束
+ * @author      hjb
+ * @version     1.0
+ * @date        2023-12-13
+ * @copyright   Copyright (c) 2023
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bpT {
+using namespace std;
+
+/**
+* @brief   关键字区间，由keyCodec::plan生成
+*/
+struct keyRange {
+    string lo = "";         // 扫描起点
+    string prefix = "";     // 前导属性等值条件的编码，区间内关键字均以此为前缀
+    string hi = "";         // bounded时的上界，以hi为前缀的关键字也在区间内
+    bool bounded = false;   // 是否有上界
+    int used = 0;           // 确定区间用到的属性个数，为0时不可用
+    int eqs = 0;            // 其中等值条件的个数
+
+    /**
+    * @brief   关键字是否在区间内，自lo起按顺序扫描时首个不在区间内的关键字即为终点
+    * @param   k
+    * @return  true
+    * @return  false
+    */
+    bool contains(string_view k) const {
+        return k.starts_with(prefix) && (!bounded || k <= hi || k.starts_with(hi));
+    }
+};
+
+/**
+* @brief   多属性关键字的编码
+*/
+struct keyCodec {
+    vector<int> columns;            // 属性下标
+    vector<bool> isInt;             // 对应属性是否为int
+    size_t limit = string::npos;    // string属性编码的最大长度，超出部分截去
+
+    /**
+    * @brief   大端序写入4个字节
+    */
+    static void putBig(string &s, uint32_t v) {
+        for (auto i = 3; i >= 0; --i) {
+            s.push_back((char)(v >> (8 * i)));
+        }
+    }
+
+    /**
+    * @brief   追加第i个属性的编码
+    * @param   k   输出
+    * @param   i   属性在关键字中的位置
+    * @param   v   属性值
+    */
+    void append(string &k, size_t i, string_view v) const {
+        if (isInt[i]) {
+            putBig(k, (uint32_t)atoi(string(v).c_str()) ^ 0x80000000u);
+        } else {
+            k.append(v.substr(0, limit));
+            k.push_back(0);
+        }
+    }
+
+    /**
+    * @brief   编码的最大长度
+    * @return  size_t  有string属性且未限定长度时为string::npos
+    */
+    size_t maxSize() const {
+        size_t n = 0;
+        for (auto i = 0uz; i < columns.size(); ++i) {
+            if (isInt[i]) {
+                n += 4;
+            } else if (limit == string::npos) {
+                return string::npos;
+            } else {
+                n += limit + 1;
+            }
+        }
+        return n;
+    }
+
+    /**
+    * @brief   编码关键字
+    * @param   vs  各属性值，顺序同columns
+    * @return  string
+    */
+    string encode(const vector<string> &vs) const {
+        string k;
+        for (auto i = 0uz; i < columns.size(); ++i) {
+            append(k, i, vs[i]);
+        }
+        return k;
+    }
+
+    /**
+    * @brief   解码关键字，int属性还原为十进制字符串
+    * @param   k   关键字，可带有其他后缀（如二级索引项的rid）
+    * @param   vs  输出，各属性值，顺序同columns
+    * @return  true    各属性值均完整
+    * @return  false   有string属性可能被截去，需读取行数据
+    */
+    bool decode(string_view k, vector<string> &vs) const {
+        bool exact = true;
+        vs.clear();
+        for (auto i = 0uz; i < columns.size(); ++i) {
+            if (isInt[i]) {
+                uint32_t v = 0;
+                for (auto j = 0; j < 4; ++j) {
+                    v = v << 8 | (uint8_t)k[j];
+                }
+                vs.push_back(to_string((int32_t)(v ^ 0x80000000u)));
+                k.remove_prefix(4);
+            } else {
+                auto n = k.find('\0');
+                vs.emplace_back(k.substr(0, n));
+                exact = exact && n < limit;
+                k.remove_prefix(n + 1);
+            }
+        }
+        return exact;
+    }
+
+    /**
+    * @brief   由where条件生成关键字区间，区间为条件的超集（比较运算的边界放宽为闭区间），由调用方按原条件再次过滤
+    * @param   conditions  where条件列表，属性下标及比较值
+    * @param   opers       > : 0; < : 1; = : 2; >= : 3; <= 4;
+    * @return  keyRange
+    */
+    keyRange plan(const vector<pair<int, string>> &conditions, const vector<char> &opers) const {
+        keyRange r;
+        auto find = [&](int col, auto pred) {
+            for (auto i = 0uz; i < conditions.size(); ++i) {
+                if (conditions[i].first == col && pred(opers[i])) {
+                    return (int)i;
+                }
+            }
+            return -1;
+        };
+        for (auto i = 0uz; i < columns.size(); ++i) {
+            int eq = find(columns[i], [](char o) { return o == 2; });
+            if (eq > -1) {
+                append(r.prefix, i, conditions[eq].second);
+                r.used++;
+                r.eqs++;
+                continue;
+            }
+            r.lo = r.prefix;
+            int ge = find(columns[i], [](char o) { return o == 0 || o == 3; });
+            int le = find(columns[i], [](char o) { return o == 1 || o == 4; });
+            if (ge > -1) {
+                append(r.lo, i, conditions[ge].second);
+            }
+            if (le > -1) {
+                r.hi = r.prefix;
+                append(r.hi, i, conditions[le].second);
+                r.bounded = true;
+            }
+            r.used += ge > -1 || le > -1;
+            return r;
+        }
+        r.lo = r.prefix;
+        return r;
+    }
+};
+}
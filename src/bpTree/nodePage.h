@@ -0,0 +1,471 @@
+/**
+ * @file        nodePage.h
+ * @brief       b+树节点页，对缓冲池中.ind文件的一页进行解释
+ *              .ind为定长页的二进制文件，关键字及页号均为本机字节序，打开表时只读取第0页，其余页在访问时经缓冲池读入
+ *              meta page（第0页）:
+ *                  xxxx xx x x xxxx xxxx xxxx xxxx xxxx xxxx
+ *                  magic version keyKind - pageSize root head tail freeList height
+ *                  version：页格式版本，magic、version、keyKind或pageSize不符的文件视为无法识别，由数据文件重建
+ *                  keyKind：0为int主键，1为string主键
+ *                  pageSize：页大小
+ *                  root：根节点页号
+ *                  head/tail：首个/最后一个叶子节点页号
+ *                  freeList：空闲页链表首页页号，-1表示无空闲页
+ *                  height：树高，只有根叶子节点时为1
+ *              node page:
+ *                  # 页头（20个字节）
+ *                  xx xx xx x x xxxx xxxx xxxx
+ *                  count freeEnd dead isLeaf prefix next prev first
+ *                  count：关键字数
+ *                  freeEnd/dead：string主键的关键字数据区起始位置/已删除关键字占用的字节数
+ *                  prefix：string主键叶子节点各关键字的公共前缀长度，前缀存放于页尾，槽目录中只存后缀
+ *                  next/prev：叶子节点的后继/前驱叶子页号，-1为链尾；空闲页以next串成空闲链表
+ *                  first：内部节点最左子节点页号，第i个关键字右侧的子节点页号存放于第i个值中
+ *                  # int主键
+ *                  # 填充至keyOffset（64个字节），关键字数组与缓存行对齐
+ *                  xxxx ...  关键字数组（capacity项）
+ *                  xxxx ...  值数组（capacity项），叶子节点为rid，内部节点为子节点页号
+ *                  # string主键
+ *                  (xx xx xxxx) ...  槽目录：关键字在页内的偏移 长度 值
+ *                  # 空闲区
+ *                  xxxxxx  关键字数据（从前缀之前向前排列）
+ *                  xxxxxx  公共前缀（prefix个字节）
+ * @author      hjb
+ * @version     1.0
+ * @date        2023-12-11
+ * @copyright   Copyright (c) 2023
+ */
+
+#pragma once
+
+#include <bit>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include "dataMgr.h"
+
+namespace bpT {
+using namespace std;
+
+static const uint32_t indMagic = 0x49545042; // "BPTI"
+static const uint16_t indVersion = 2;         // 页格式改变时递增
+
+/**
+* @brief   元数据页
+*/
+struct indexMeta {
+    uint32_t magic = indMagic;
+    uint16_t version = indVersion;
+    uint8_t keyKind = 0;
+    uint8_t reserved = 0;
+    int32_t pageSize = maxPageSize;
+    int32_t root = 1;
+    int32_t head = 1;
+    int32_t tail = 1;
+    int32_t freeList = -1;
+    int32_t height = 1;
+};
+
+/**
+* @brief   节点页头
+*/
+struct nodeHeader {
+    uint16_t count;
+    uint16_t freeEnd;
+    uint16_t dead;
+    uint8_t isLeaf;
+    uint8_t prefix;
+    int32_t next;
+    int32_t prev;
+    int32_t first;
+};
+
+/**
+* @brief   节点页的公共部分
+*/
+struct nodeBase {
+    char *data;
+
+    nodeBase(char *data) : data(data) {}
+
+    nodeHeader *header() const {
+        return (nodeHeader *)data;
+    }
+    int count() const {
+        return header()->count;
+    }
+    bool isLeaf() const {
+        return header()->isLeaf;
+    }
+    int next() const {
+        return header()->next;
+    }
+    void setNext(int n) {
+        header()->next = n;
+    }
+    int prev() const {
+        return header()->prev;
+    }
+    void setPrev(int n) {
+        header()->prev = n;
+    }
+
+    /**
+    * @brief   初始化为空节点
+    * @param   leaf    是否为叶子节点
+    */
+    void format(bool leaf) {
+        memset(data, 0, sizeof(nodeHeader));
+        header()->freeEnd = maxPageSize;
+        header()->isLeaf = leaf;
+        header()->next = -1;
+        header()->prev = -1;
+        header()->first = -1;
+    }
+};
+
+template <typename T>
+struct nodePage;
+
+/**
+* @brief   int主键节点，关键字与值分别连续存放
+*          节点内查找先二分缩小到simdBlock个关键字以内，再以向量比较统计小于目标的关键字数：
+*          AVX2每次比较8个，SSE2每次比较4个，其余平台逐个比较
+*/
+template <>
+struct nodePage<int> : nodeBase {
+    using key_ref = int;
+    static constexpr size_t keyOffset = 64;
+    static constexpr int capacity = (maxPageSize - keyOffset) / 8;
+    static constexpr size_t maxKeySize = 4;
+    static constexpr int simdBlock = 32;
+
+    using nodeBase::nodeBase;
+
+    int *keys() const {
+        return (int *)(data + keyOffset);
+    }
+    int *vals() const {
+        return keys() + capacity;
+    }
+    int key(int i) const {
+        return keys()[i];
+    }
+    bool equals(int i, int k) const {
+        return key(i) == k;
+    }
+    int val(int i) const {
+        return vals()[i];
+    }
+    void setVal(int i, int v) {
+        vals()[i] = v;
+    }
+
+    /**
+    * @brief   关键字及其值占用的字节数
+    * @param   k
+    * @return  size_t
+    */
+    static size_t entrySize(int k) {
+        return 8;
+    }
+
+    /**
+    * @brief   分隔left与right所在子节点的关键字
+    */
+    static int separator(int left, int right) {
+        return right;
+    }
+
+    /**
+    * @brief   能否再插入关键字k
+    * @param   k
+    */
+    bool fits(int k) const {
+        return count() < capacity;
+    }
+
+    /**
+    * @brief   在第i个位置插入关键字，调用前需确认fits
+    * @param   i
+    * @param   k
+    * @param   v
+    */
+    void insert(int i, int k, int v) {
+        int n = count();
+        memmove(keys() + i + 1, keys() + i, 4 * (n - i));
+        memmove(vals() + i + 1, vals() + i, 4 * (n - i));
+        keys()[i] = k;
+        vals()[i] = v;
+        header()->count++;
+    }
+    void erase(int i) {
+        int n = count();
+        memmove(keys() + i, keys() + i + 1, 4 * (n - i - 1));
+        memmove(vals() + i, vals() + i + 1, 4 * (n - i - 1));
+        header()->count--;
+    }
+
+    /**
+    * @brief   清空关键字，保留节点类型及链接
+    */
+    void clear() {
+        header()->count = 0;
+    }
+    void clear(int first, int last) {
+        clear();
+    }
+
+    /**
+    * @brief   首个不小于k的关键字位置
+    */
+    int lowerBound(int k) const {
+        return rank(k, false);
+    }
+    /**
+    * @brief   首个大于k的关键字位置
+    */
+    int upperBound(int k) const {
+        return rank(k, true);
+    }
+
+private:
+    /**
+    * @brief   小于k（orEqual时为不大于k）的关键字数
+    * @param   k
+    * @param   orEqual
+    * @return  int
+    */
+    int rank(int k, bool orEqual) const {
+        const int *a = keys();
+        int lo = 0, hi = count();
+        while (hi - lo > simdBlock) {
+            int mid = (lo + hi) / 2;
+            bool right = a[mid] < k || (orEqual && a[mid] == k);
+            lo = right ? mid + 1 : lo;
+            hi = right ? hi : mid;
+        }
+        if (orEqual) {
+            if (k == INT_MAX) {
+                return hi;
+            }
+            k++;
+        }
+        return lo + countLess(a + lo, hi - lo, k);
+    }
+
+    /**
+    * @brief   a[0, n)中小于k的元素个数
+    */
+    static int countLess(const int *a, int n, int k) {
+        int i = 0, res = 0;
+#if defined(__AVX2__)
+        __m256i kv = _mm256_set1_epi32(k);
+        for (; i + 8 <= n; i += 8) {
+            __m256i lt = _mm256_cmpgt_epi32(kv, _mm256_loadu_si256((const __m256i *)(a + i)));
+            res += popcount((unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(lt)));
+        }
+#elif defined(__SSE2__)
+        __m128i kv = _mm_set1_epi32(k);
+        for (; i + 4 <= n; i += 4) {
+            __m128i lt = _mm_cmplt_epi32(_mm_loadu_si128((const __m128i *)(a + i)), kv);
+            res += popcount((unsigned)_mm_movemask_ps(_mm_castsi128_ps(lt)));
+        }
+#endif
+        for (; i < n; ++i) {
+            res += a[i] < k;
+        }
+        return res;
+    }
+};
+
+/**
+* @brief   string主键节点，槽目录从页头向后增长，关键字数据从页尾向前增长
+*          叶子节点将各关键字的公共前缀提出，存放于页尾，槽目录只记录后缀；
+*          插入不具有该前缀的关键字时缩短前缀，重写全部后缀
+*/
+template <>
+struct nodePage<string> : nodeBase {
+    using key_ref = string;
+    struct slot {
+        uint16_t offset;
+        uint16_t size;
+        int32_t val;
+    };
+    static constexpr int capacity = (maxPageSize - sizeof(nodeHeader)) / sizeof(slot);
+    static constexpr size_t maxKeySize = (maxPageSize - sizeof(nodeHeader)) / 4 - sizeof(slot);
+    static constexpr size_t maxPrefix = UINT8_MAX;
+
+    using nodeBase::nodeBase;
+
+    slot *slots() const {
+        return (slot *)(data + sizeof(nodeHeader));
+    }
+    string_view prefix() const {
+        return string_view(data + maxPageSize - header()->prefix, header()->prefix);
+    }
+    string_view suffix(int i) const {
+        return string_view(data + slots()[i].offset, slots()[i].size);
+    }
+    string key(int i) const {
+        string k(prefix());
+        k += suffix(i);
+        return k;
+    }
+    bool equals(int i, string_view k) const {
+        string_view pre = prefix();
+        return k.starts_with(pre) && k.substr(pre.size()) == suffix(i);
+    }
+    int val(int i) const {
+        return slots()[i].val;
+    }
+    void setVal(int i, int v) {
+        slots()[i].val = v;
+    }
+
+    static size_t entrySize(string_view k) {
+        return sizeof(slot) + k.size();
+    }
+
+    /**
+    * @brief   分隔left与right所在子节点的最短关键字，即right中比left多出一个字节的前缀
+    * @param   left    左子节点的最大关键字
+    * @param   right   右子节点的最小关键字
+    * @return  string
+    */
+    static string separator(string_view left, string_view right) {
+        return string(right.substr(0, commonPrefix(left, right) + 1));
+    }
+
+    bool fits(string_view k) const {
+        size_t used = sizeof(nodeHeader) + sizeof(slot) * count() + maxPageSize - header()->freeEnd - header()->dead;
+        size_t p = header()->prefix, s = min(p, commonPrefix(prefix(), k));
+        // 前缀缩短为s个字节时，前缀区减少p-s个字节，每个后缀增加p-s个字节
+        return used - (p - s) + count() * (p - s) + entrySize(k) - s <= maxPageSize;
+    }
+
+    void insert(int i, string_view k, int v) {
+        size_t s = commonPrefix(prefix(), k);
+        if (s < header()->prefix) {
+            shrinkPrefix(s);
+        }
+        k.remove_prefix(header()->prefix);
+        int n = count();
+        if (sizeof(nodeHeader) + sizeof(slot) * (n + 1) + k.size() > header()->freeEnd) {
+            compact();
+        }
+        header()->freeEnd -= k.size();
+        memcpy(data + header()->freeEnd, k.data(), k.size());
+        memmove(slots() + i + 1, slots() + i, sizeof(slot) * (n - i));
+        slots()[i] = slot{header()->freeEnd, (uint16_t)k.size(), v};
+        header()->count++;
+    }
+    void erase(int i) {
+        header()->dead += slots()[i].size;
+        memmove(slots() + i, slots() + i + 1, sizeof(slot) * (count() - i - 1));
+        header()->count--;
+    }
+
+    void clear() {
+        header()->count = 0;
+        header()->freeEnd = maxPageSize;
+        header()->dead = 0;
+        header()->prefix = 0;
+    }
+    /**
+    * @brief   清空关键字，叶子节点以随后存入的首末关键字的公共部分为前缀
+    * @param   first   最小关键字
+    * @param   last    最大关键字
+    */
+    void clear(string_view first, string_view last) {
+        clear();
+        if (!isLeaf()) {
+            return;
+        }
+        size_t p = min(commonPrefix(first, last), maxPrefix);
+        header()->prefix = p;
+        header()->freeEnd = maxPageSize - p;
+        memcpy(data + header()->freeEnd, first.data(), p);
+    }
+
+    /**
+    * @brief   首个不小于k的关键字位置
+    */
+    int lowerBound(string_view k) const {
+        return bound(k, [](string_view a, string_view b) { return a < b; });
+    }
+    /**
+    * @brief   首个大于k的关键字位置
+    */
+    int upperBound(string_view k) const {
+        return bound(k, [](string_view a, string_view b) { return !(b < a); });
+    }
+
+private:
+    static size_t commonPrefix(string_view a, string_view b) {
+        return mismatch(a.begin(), a.begin() + min(a.size(), b.size()), b.begin()).first - a.begin();
+    }
+
+    /**
+    * @brief   首个使before(后缀, k的后缀)为false的位置，k不具有前缀时直接由其与前缀的大小决定
+    */
+    template <typename F>
+    int bound(string_view k, F before) const {
+        string_view pre = prefix();
+        if (!k.starts_with(pre)) {
+            return k < pre ? 0 : count();
+        }
+        k.remove_prefix(pre.size());
+        return *ranges::partition_point(views::iota(0, count()), [&](int i) { return before(suffix(i), k); });
+    }
+
+    /**
+    * @brief   将前缀缩短为s个字节，被移出前缀的部分补到每个后缀之前
+    * @param   s
+    */
+    void shrinkPrefix(size_t s) {
+        string pre(prefix());
+        vector<pair<string, int>> es;
+        es.reserve(count());
+        for (auto i = 0; i < count(); ++i) {
+            es.emplace_back(key(i), val(i));
+        }
+        header()->prefix = s;
+        header()->freeEnd = maxPageSize - s;
+        header()->dead = 0;
+        memcpy(data + header()->freeEnd, pre.data(), s);
+        for (auto i = 0; i < count(); ++i) {
+            string_view suf = string_view(es[i].first).substr(s);
+            header()->freeEnd -= suf.size();
+            memcpy(data + header()->freeEnd, suf.data(), suf.size());
+            slots()[i] = slot{header()->freeEnd, (uint16_t)suf.size(), es[i].second};
+        }
+    }
+
+    /**
+    * @brief   紧缩关键字数据区，回收已删除关键字的空间
+    */
+    void compact() {
+        string buf(data + header()->freeEnd, maxPageSize - header()->freeEnd);
+        size_t base = header()->freeEnd;
+        uint16_t end = maxPageSize - header()->prefix;
+        for (auto i = 0; i < count(); ++i) {
+            auto &s = slots()[i];
+            end -= s.size;
+            memcpy(data + end, buf.data() + s.offset - base, s.size);
+            s.offset = end;
+        }
+        header()->freeEnd = end;
+        header()->dead = 0;
+    }
+};
+}
@@ -0,0 +1,302 @@
+/**
+ * @file        prefetch.h
+ * @brief       批量读取的异步预取
+ *              将一批rid所在的页排序去重，跳过已在系统页缓存中的页，其余页合并为连续区间
+ *              （每段不超过prefetchRunPages页），交给后台读线程以pread读入页缓存
+ *              读取方按原顺序处理行，访问某页前等待其所在区间读完，已完成的区间立即返回，
+ *              从而在处理先读到的行时，后续区间的I/O在后台并行进行
+ *              顺序预读：
+ *              按处理顺序页号基本递增（相邻两行的页号差在0~readaheadGap之间）的批量读取视为顺序扫描，
+ *              不再逐页预取，而是在连续readaheadTrigger行递增后，对映射提前readaheadWindow()页发出
+ *              MADV_WILLNEED，由内核异步读入，随扫描推进滑动窗口；窗口大小可由set readahead调整，0关闭顺序预读
+ * @author      hjb
+ * @version     1.0
+ * @date        2023-12-10
+ * @copyright   Copyright (c) 2023
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bpT {
+using namespace std;
+
+static const int prefetchThreads = 4;       // 后台读线程数
+static const int prefetchRunPages = 16;     // 单次读取的最大页数
+static const int prefetchMinPages = 2;      // 需要读取的页数不少于此值时才启用预取
+static const int readaheadGap = 2;          // 相邻两行页号之差不超过此值时视为顺序
+static const int readaheadTrigger = 4;      // 连续顺序的行数达到此值后开始预读
+
+/**
+* @brief   顺序扫描时提前预读的页数，初始为32
+* @return  int&
+*/
+inline int &readaheadWindow() {
+    static int w = 32;
+    return w;
+}
+
+/**
+* @brief   后台读线程池，线程在首次提交任务时创建
+*/
+class readerPool {
+private:
+    vector<thread> workers;
+    deque<function<void()>> jobs;
+    mutex m;
+    condition_variable cv;
+    bool stop = false;
+
+    void work() {
+        while (true) {
+            function<void()> job;
+            {
+                unique_lock lk(m);
+                cv.wait(lk, [this] { return stop || !jobs.empty(); });
+                if (jobs.empty()) {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+public:
+    readerPool() = default;
+    readerPool(const readerPool &) = delete;
+    ~readerPool() noexcept {
+        {
+            lock_guard lk(m);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto &t : workers) {
+            t.join();
+        }
+    }
+
+    /**
+    * @brief   提交读任务
+    * @param   job
+    */
+    void submit(function<void()> job) {
+        {
+            lock_guard lk(m);
+            if (workers.empty()) {
+                for (auto i = 0; i < prefetchThreads; ++i) {
+                    workers.emplace_back(&readerPool::work, this);
+                }
+            }
+            jobs.push_back(std::move(job));
+        }
+        cv.notify_one();
+    }
+};
+
+/**
+* @brief   全局读线程池
+* @return  readerPool&
+*/
+inline readerPool &readers() {
+    static readerPool p;
+    return p;
+}
+
+/**
+* @brief   一次批量读取的预取
+*/
+class prefetcher {
+private:
+    /**
+    * @brief   与后台任务共享的状态，任务持有其引用，读取方提前结束时不会失效
+    */
+    struct state {
+        int fd = -1;
+        size_t pageSize = 0;
+        vector<pair<int, int>> runs;        // 各区间的首页与尾页
+        unique_ptr<atomic<bool>[]> done;    // 各区间是否已读完
+        mutex m;
+        condition_variable cv;
+
+        ~state() {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    };
+    shared_ptr<state> st;
+
+    const char *map = nullptr;  // 文件映射起始地址
+    size_t size = 0;            // 映射长度
+    size_t pageSize = 0;        // 页大小
+    bool sequential = false;    // 本批是否按顺序预读
+    int last = -1;              // 上一行的页号
+    int run = 0;                // 连续顺序的行数
+    int advised = -1;           // 已预读到的页号
+
+    /**
+    * @brief   页是否已全部在系统页缓存中
+    * @param   pageNo
+    */
+    bool resident(int pageNo) {
+        static const size_t osPage = sysconf(_SC_PAGESIZE);
+        size_t beg = (size_t)pageNo * pageSize;
+        size_t end = min(beg + pageSize, size);
+        beg -= beg % osPage;
+        unsigned char vec[64];
+        size_t n = (end - beg + osPage - 1) / osPage;
+        if (n > sizeof(vec) || mincore((void *)(map + beg), end - beg, vec) != 0) {
+            return false;
+        }
+        for (auto i = 0uz; i < n; ++i) {
+            if (!(vec[i] & 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+    * @brief   按处理顺序的页号是否基本递增，至少3/4的相邻行满足顺序条件
+    * @param   pages   页号，按处理顺序
+    */
+    static bool isSequential(const vector<int> &pages) {
+        if (pages.size() < (size_t)readaheadTrigger) {
+            return false;
+        }
+        size_t steps = 0;
+        for (auto i = 1uz; i < pages.size(); ++i) {
+            int d = pages[i] - pages[i - 1];
+            steps += d >= 0 && d <= readaheadGap;
+        }
+        return steps * 4 >= (pages.size() - 1) * 3;
+    }
+
+    /**
+    * @brief   顺序预读：记录本行页号，顺序行数达到阈值后保持预读窗口在当前页之前
+    * @param   pageNo
+    */
+    void advance(int pageNo) {
+        int d = pageNo - last;
+        run = (last >= 0 && d >= 0 && d <= readaheadGap) ? run + 1 : 0;
+        last = pageNo;
+        int window = readaheadWindow();
+        if (window == 0 || run < readaheadTrigger || advised >= pageNo + window / 2) {
+            return;
+        }
+        int pages = size / pageSize;
+        int from = max(advised + 1, pageNo + 1), to = min(pageNo + window, pages - 1);
+        if (from <= to) {
+            madvise((void *)(map + (size_t)from * pageSize), (size_t)(to - from + 1) * pageSize, MADV_WILLNEED);
+        }
+        advised = to;
+    }
+
+public:
+    /**
+    * @brief   为一批页发起预取，之前的预取不再等待
+    * @param   filename    数据文件路径
+    * @param   map         文件映射起始地址
+    * @param   size        映射长度
+    * @param   pageSize    页大小
+    * @param   pages       页号，按处理顺序
+    */
+    void start(const string &filename, const char *map, size_t size, size_t pageSize, vector<int> pages) {
+        st = nullptr;
+        this->map = map;
+        this->size = size;
+        this->pageSize = pageSize;
+        last = -1;
+        run = 0;
+        advised = -1;
+        sequential = isSequential(pages);
+        if (sequential) {
+            return;
+        }
+        sort(pages.begin(), pages.end());
+        pages.erase(unique(pages.begin(), pages.end()), pages.end());
+        vector<int> cold;
+        for (auto p : pages) {
+            if (p >= 0 && (size_t)(p + 1) * pageSize <= size && !resident(p)) {
+                cold.push_back(p);
+            }
+        }
+        if ((int)cold.size() < prefetchMinPages) {
+            return;
+        }
+        auto s = make_shared<state>();
+        s->fd = open(filename.c_str(), O_RDONLY);
+        if (s->fd < 0) {
+            return;
+        }
+        s->pageSize = pageSize;
+        for (auto p : cold) {
+            auto &r = s->runs;
+            if (!r.empty() && r.back().second == p - 1 && p - r.back().first < prefetchRunPages) {
+                r.back().second = p;
+            } else {
+                r.emplace_back(p, p);
+            }
+        }
+        s->done = make_unique<atomic<bool>[]>(s->runs.size());
+        for (auto k = 0uz; k < s->runs.size(); ++k) {
+            readers().submit([s, k] {
+                auto [first, last] = s->runs[k];
+                static thread_local vector<char> buf;
+                buf.resize((last - first + 1) * s->pageSize);
+                if (pread(s->fd, buf.data(), buf.size(), (off_t)first * s->pageSize) < 0) {
+                    buf.clear(); // 读取失败时由映射的缺页处理读取
+                }
+                {
+                    lock_guard lk(s->m);
+                    s->done[k] = true;
+                }
+                s->cv.notify_all();
+            });
+        }
+        st = s;
+    }
+
+    /**
+    * @brief   访问页前调用：顺序扫描时推进预读窗口，否则等待页所在的区间读完，页不在预取范围内时立即返回
+    * @param   pageNo
+    */
+    void wait(int pageNo) {
+        if (sequential) {
+            advance(pageNo);
+            return;
+        }
+        if (st == nullptr) {
+            return;
+        }
+        auto &r = st->runs;
+        auto itr = upper_bound(r.begin(), r.end(), pair<int, int>(pageNo, INT_MAX));
+        if (itr == r.begin() || (--itr)->second < pageNo) {
+            return;
+        }
+        auto k = itr - r.begin();
+        if (st->done[k]) {
+            return;
+        }
+        unique_lock lk(st->m);
+        st->cv.wait(lk, [&] { return st->done[k].load(); });
+    }
+};
+}
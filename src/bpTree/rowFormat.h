@@ -0,0 +1,314 @@
+/**
+ * @file        rowFormat.h
+ * @brief       行存储格式
+ *              row:
+ *                  # 版本号（1个字节）
+ *                  x    rowVersion，读取时检查，不符的行不按当前格式解释（见dataMgr::checkRow）
+ *                  # int区（每个int属性4个字节，按属性顺序排列）
+ *                  xxxx xxxx ...
+ *                  # 偏移表（每个string属性2个字节，按属性顺序排列）
+ *                  xx xx ...  该string在行内的结束位置，最高位为1表示该string存放于溢出页
+ *                  # string区
+ *                  xxxxxx
+ *                  溢出的string在string区中仅存放引用（8个字节）：
+ *                  xxxx xxxx  溢出链首页页号 string长度
+ *              int属性及偏移表位置由表结构预先算出，读取任意属性均只需一次定位
+ *              行超过限制长度时，从最长的string开始依次移入溢出页，直至剩余部分不超过限制
+ * @author      hjb
+ * @version     1.0
+ * @date        2023-12-06
+ * @copyright   Copyright (c) 2023
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bpT {
+using namespace std;
+
+static const uint8_t rowVersion = 1;
+static const uint16_t extFlag = 0x8000;
+static const size_t refSize = 8;
+
+/**
+* @brief   将string写入溢出页，返回其引用
+*/
+using spillFunc = function<string(string_view)>;
+
+/**
+* @brief   由表结构得到的行布局
+*/
+class rowLayout {
+private:
+    vector<char> types;     // 属性是否为int类型
+    vector<int> slots;      // 属性在int区或偏移表中的下标
+    int nInt = 0;           // int属性个数
+    int nStr = 0;           // string属性个数
+
+public:
+    rowLayout() = default;
+    rowLayout(const vector<char> &types) {
+        this->types = types;
+        for (auto i : types) {
+            slots.push_back(i == 1 ? nInt++ : nStr++);
+        }
+    }
+
+    size_t size() const {
+        return types.size();
+    }
+    bool isInt(int k) const {
+        return types[k] == 1;
+    }
+
+    /**
+    * @brief   int属性在行内的位置
+    * @param   k   属性下标
+    * @return  size_t
+    */
+    size_t intOffset(int k) const {
+        return 1 + 4 * slots[k];
+    }
+    /**
+    * @brief   string属性在偏移表中的位置
+    * @param   k   属性下标
+    * @return  size_t
+    */
+    size_t endOffset(int k) const {
+        return 1 + 4 * nInt + 2 * slots[k];
+    }
+    /**
+    * @brief   string区起始位置
+    * @return  size_t
+    */
+    size_t strBase() const {
+        return 1 + 4 * nInt + 2 * nStr;
+    }
+    /**
+    * @brief   string属性的起始位置在偏移表中的位置，首个string属性返回0
+    * @param   k   属性下标
+    * @return  size_t
+    */
+    size_t begOffset(int k) const {
+        return slots[k] == 0 ? 0 : endOffset(k) - 2;
+    }
+
+    /**
+    * @brief   string属性在行内占据的区间，溢出的string为其引用
+    * @param   row 行
+    * @param   k   属性下标
+    * @return  string_view
+    */
+    string_view span(string_view row, int k) const {
+        uint16_t beg = strBase(), end = 0;
+        if (begOffset(k) != 0) {
+            memcpy(&beg, row.data() + begOffset(k), 2);
+            beg &= ~extFlag;
+        }
+        memcpy(&end, row.data() + endOffset(k), 2);
+        end &= ~extFlag;
+        return row.substr(beg, end - beg);
+    }
+    /**
+    * @brief   string属性是否存放于溢出页
+    * @param   row 行
+    * @param   k   属性下标
+    */
+    bool external(string_view row, int k) const {
+        uint16_t end = 0;
+        memcpy(&end, row.data() + endOffset(k), 2);
+        return (end & extFlag) != 0;
+    }
+    /**
+    * @brief   行中所有溢出string的引用
+    * @param   row 行
+    * @return  vector<pair<int, int>> 溢出链首页页号及string长度
+    */
+    vector<pair<int, int>> refs(string_view row) const {
+        vector<pair<int, int>> res;
+        for (auto i = 0uz; i < types.size(); ++i) {
+            if (!isInt(i) && external(row, i)) {
+                auto r = span(row, i);
+                pair<int, int> ref;
+                memcpy(&ref.first, r.data(), 4);
+                memcpy(&ref.second, r.data() + 4, 4);
+                res.push_back(ref);
+            }
+        }
+        return res;
+    }
+
+    /**
+    * @brief   将属性值编码为行
+    * @param   values  属性值，int属性为十进制字符串
+    * @param   limit   行的限制长度
+    * @param   spill   超出限制时写入溢出页的方法，为空则不溢出
+    * @return  string
+    */
+    string encode(const vector<string> &values, size_t limit = SIZE_MAX, const spillFunc &spill = nullptr) const {
+        vector<int> ivals(types.size(), 0);
+        vector<string_view> parts(types.size());
+        vector<char> ext(types.size(), 0);
+        for (auto i = 0uz; i < types.size(); ++i) {
+            if (isInt(i)) {
+                ivals[i] = atoi(values[i].c_str());
+                parts[i] = string_view((char *)&ivals[i], 4);
+            } else {
+                parts[i] = values[i];
+            }
+        }
+        return build(parts, ext, limit, spill);
+    }
+
+    /**
+    * @brief   修改行中的一个属性，其余属性（含溢出引用）原样保留
+    * @param   row     原行
+    * @param   k       属性下标
+    * @param   v       新值，int属性为十进制字符串
+    * @param   limit   行的限制长度
+    * @param   spill   超出限制时写入溢出页的方法，为空则不溢出
+    * @return  string  新行
+    */
+    string set(string_view row, int k, const string &v, size_t limit = SIZE_MAX, const spillFunc &spill = nullptr) const {
+        if (isInt(k)) {
+            string res(row);
+            int iv = atoi(v.c_str());
+            memcpy(res.data() + intOffset(k), &iv, 4);
+            return res;
+        }
+        vector<string_view> parts(types.size());
+        vector<char> ext(types.size(), 0);
+        for (auto i = 0uz; i < types.size(); ++i) {
+            if (isInt(i)) {
+                parts[i] = row.substr(intOffset(i), 4);
+            } else {
+                parts[i] = span(row, i);
+                ext[i] = external(row, i);
+            }
+        }
+        parts[k] = v;
+        ext[k] = 0;
+        return build(parts, ext, limit, spill);
+    }
+
+    /**
+    * @brief   由各属性的字节组装行，超出限制时从最长的string开始移入溢出页
+    * @param   parts   int属性为4个字节，string属性为数据或溢出引用
+    * @param   ext     string属性是否已溢出
+    * @param   limit   行的限制长度
+    * @param   spill   写入溢出页的方法
+    * @return  string
+    */
+    string build(vector<string_view> &parts, vector<char> &ext, size_t limit = SIZE_MAX,
+                 const spillFunc &spill = nullptr) const {
+        vector<string> held(types.size());
+        size_t total = strBase();
+        for (auto i = 0uz; i < types.size(); ++i) {
+            if (!isInt(i)) {
+                total += parts[i].size();
+            }
+        }
+        while (total > limit && spill) {
+            int k = -1;
+            for (auto i = 0uz; i < types.size(); ++i) {
+                if (!isInt(i) && !ext[i] && parts[i].size() > refSize &&
+                    (k == -1 || parts[i].size() > parts[k].size())) {
+                    k = i;
+                }
+            }
+            if (k == -1) {
+                break;
+            }
+            held[k] = spill(parts[k]);
+            total -= parts[k].size() - refSize;
+            parts[k] = held[k];
+            ext[k] = 1;
+        }
+        string row(total, 0);
+        row[0] = rowVersion;
+        uint16_t end = strBase();
+        for (auto i = 0uz; i < types.size(); ++i) {
+            if (isInt(i)) {
+                memcpy(row.data() + intOffset(i), parts[i].data(), 4);
+            } else {
+                memcpy(row.data() + end, parts[i].data(), parts[i].size());
+                end += parts[i].size();
+                uint16_t e = end | (ext[i] ? extFlag : 0);
+                memcpy(row.data() + endOffset(i), &e, 2);
+            }
+        }
+        return row;
+    }
+};
+
+/**
+* @brief   行的只读视图，按需读取单个属性
+*/
+struct rowView {
+public:
+    string_view row;
+    const rowLayout *layout;
+
+    rowView(string_view row, const rowLayout &layout) {
+        this->row = row;
+        this->layout = &layout;
+    }
+
+    /**
+    * @brief   读取int属性
+    * @param   k   属性下标
+    * @return  int
+    */
+    int getInt(int k) const {
+        int v = 0;
+        memcpy(&v, row.data() + layout->intOffset(k), 4);
+        return v;
+    }
+    /**
+    * @brief   读取行内string属性，溢出的string返回其引用
+    * @param   k   属性下标
+    * @return  string_view 指向行内数据
+    */
+    string_view getStr(int k) const {
+        return layout->span(row, k);
+    }
+    /**
+    * @brief   string属性是否存放于溢出页
+    * @param   k   属性下标
+    */
+    bool external(int k) const {
+        return !layout->isInt(k) && layout->external(row, k);
+    }
+    /**
+    * @brief   溢出string的引用
+    * @param   k   属性下标
+    * @return  pair<int, int> 溢出链首页页号及string长度
+    */
+    pair<int, int> ref(int k) const {
+        pair<int, int> res;
+        auto r = getStr(k);
+        memcpy(&res.first, r.data(), 4);
+        memcpy(&res.second, r.data() + 4, 4);
+        return res;
+    }
+    /**
+    * @brief   以字符串形式读取行内属性，溢出的string需经dataMgr::getColumn读取
+    * @param   k   属性下标
+    * @return  string
+    */
+    string get(int k) const {
+        if (layout->isInt(k)) {
+            return to_string(getInt(k));
+        }
+        return string(getStr(k));
+    }
+};
+}
@@ -0,0 +1,239 @@
+/**
+ * @file        secondaryIndex.h
+ * @brief       二级索引
+ *              每个二级索引为一棵b+树，存放于table.<索引名>.ind，页格式同主键索引（见nodePage.h）
+ *              可建立在一个或多个属性上，属性值可重复，故以 属性值编码 + rid 作为string关键字，值为rid：
+ *                  xxxxxx  各属性值的保序编码（见keyCodec.h），string属性超过maxRecSize的部分截去
+ *                  xxxx  rid的大端序
+ *              查找时只按属性值定位区间，截去的值及比较运算的边界均放宽为闭区间，由调用方按原条件再次过滤
+ *              语句只涉及索引属性时由索引项中的属性值直接作答，不读取数据文件，只有可能被截去的值才读取行数据
+ *              b+树索引另以Bloom过滤器（table.<索引名>.bloom）记录出现过的属性值，全部属性均为等值条件且值一定不存在时不查找索引
+ *              using hash的索引改用线性hash（见hashIndex.h），存放于table.<索引名>.hash，只用于全部属性均为等值条件的查找
+ * @author      hjb
+ * @version     1.0
+ * @date        2023-12-12
+ * @copyright   Copyright (c) 2023
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "bloomFilter.h"
+#include "bpTree.h"
+#include "hashIndex.h"
+#include "keyCodec.h"
+
+namespace bpT {
+using namespace std;
+
+/**
+* @brief   二级索引
+*/
+class secondaryIndex {
+private:
+    bpTree<string> t;       // 索引项
+    hashIndex h;            // hash索引的索引项
+    bloomFilter bloom;      // b+树索引的属性值过滤器
+    string filename;        // 索引文件路径
+
+    /**
+    * @brief   索引项的关键字
+    * @param   v   属性值的编码
+    * @param   rid
+    * @return  string
+    */
+    static string entry(const string &v, int rid) {
+        string k = v;
+        keyCodec::putBig(k, rid);
+        return k;
+    }
+
+    /**
+    * @brief   由索引项中的属性值重建过滤器
+    */
+    void rebuildBloom() {
+        vector<string> vs;
+        t.scanEntries("", [&](const string &e, int) {
+            vs.push_back(e.substr(0, e.size() - 4));
+            return true;
+        });
+        bloom.reset(vs.size() * 2);
+        for (auto &v : vs) {
+            bloom.add(v);
+        }
+    }
+
+public:
+    string name = "";       // 索引名
+    keyCodec codec;         // 索引属性及其编码
+    bool hashed = false;    // 是否为hash索引
+
+    /**
+    * @brief   索引项的关键字能否放入b+树节点，hash索引只保存属性值的hash，总能放入
+    * @param   columns 属性下标
+    * @param   isInt   各属性是否为int
+    * @param   hashed  是否为hash索引
+    */
+    static bool fits(const vector<int> &columns, const vector<bool> &isInt, bool hashed) {
+        return hashed || keyCodec {columns, isInt, maxRecSize}.maxSize() + 4 <= bpTree<string>::node::maxKeySize;
+    }
+
+    /**
+    * @brief   打开表上的二级索引
+    * @param   database
+    * @param   table
+    * @param   name    索引名
+    * @param   columns 属性下标
+    * @param   isInt   各属性是否为int
+    * @param   hashed  是否为hash索引
+    */
+    void init(const string &database, const string &table, const string &name, const vector<int> &columns,
+              const vector<bool> &isInt, bool hashed = false) {
+        this->name = name;
+        this->codec = keyCodec {columns, isInt, maxRecSize};
+        this->hashed = hashed;
+        this->filename = dataPos + database + "/" + table + "." + name + (hashed ? ".hash" : ".ind");
+        if (hashed) {
+            h.init(filename);
+        } else {
+            t.init(database, table + "." + name);
+            bloom.init(dataPos + database + "/" + table + "." + name + ".bloom");
+        }
+    }
+
+    /**
+    * @brief   索引文件是否存在，b+树索引还须能够识别，否则由调用方重建
+    */
+    bool exists() {
+        return filesystem::exists(filename) && (hashed || t.valid());
+    }
+
+    /**
+    * @brief   索引的属性下标
+    */
+    const vector<int> &columns() const {
+        return codec.columns;
+    }
+
+    /**
+    * @brief   属性值的编码，同一组属性值的全部索引项以此为前缀
+    * @param   vs  各属性值，顺序同columns()
+    * @return  string
+    */
+    string encode(const vector<string> &vs) const {
+        return codec.encode(vs);
+    }
+
+    void insert(const string &v, int rid) {
+        if (hashed) {
+            h.insert(hashIndex::hashOf(v), rid);
+        } else {
+            t.insertEntry(entry(v, rid), rid);
+            if (bloom.valid() && !bloom.full()) {
+                bloom.add(v);
+            } else {
+                rebuildBloom();
+            }
+        }
+    }
+    void erase(const string &v, int rid) {
+        if (hashed) {
+            h.erase(hashIndex::hashOf(v), rid);
+        } else {
+            t.eraseEntry(entry(v, rid));
+        }
+    }
+
+    /**
+    * @brief   丢弃原有索引项，批量重建
+    * @param   vs  属性值的编码及rid
+    */
+    void build(const vector<pair<string, int>> &vs) {
+        if (hashed) {
+            vector<pair<uint32_t, int>> hs;
+            hs.reserve(vs.size());
+            for (auto &i : vs) {
+                hs.emplace_back(hashIndex::hashOf(i.first), i.second);
+            }
+            h.build(hs);
+            return;
+        }
+        vector<pair<string, int>> es;
+        es.reserve(vs.size());
+        for (auto &i : vs) {
+            es.emplace_back(entry(i.first, i.second), i.second);
+        }
+        t.buildEntries(es);
+        bloom.reset(vs.size() * 2);
+        for (auto &i : vs) {
+            bloom.add(i.first);
+        }
+    }
+
+    /**
+    * @brief   能否用于该区间的查找，hash索引要求全部属性均为等值条件
+    * @param   r   由codec.plan生成的区间
+    */
+    bool usable(const keyRange &r) const {
+        return hashed ? r.eqs == (int)codec.columns.size() : r.used > 0;
+    }
+
+    /**
+    * @brief   查找关键字区间内的行，结果为条件的超集
+    * @param   r       由codec.plan生成的区间
+    * @param   rids    输出，rid
+    * @param   vals    输出，各索引项中属性值的编码，为空时不输出；hash索引不保存属性值，不可用
+    */
+    void find(const keyRange &r, vector<int> &rids, vector<string> *vals = nullptr) {
+        if (hashed) {
+            h.find(hashIndex::hashOf(r.prefix), rids);
+            return;
+        }
+        if (r.eqs == (int)codec.columns.size()) {
+            if (!bloom.valid()) {
+                rebuildBloom();
+            }
+            if (!bloom.mayContain(r.prefix)) {
+                return;
+            }
+        }
+        t.scanEntries(r.lo, [&](const string &e, int rid) {
+            if (!r.contains(e)) {
+                return false;
+            }
+            rids.push_back(rid);
+            if (vals) {
+                vals->push_back(e.substr(0, e.size() - 4));
+            }
+            return true;
+        });
+    }
+
+    /**
+    * @brief   将索引的脏页写回磁盘
+    * @return  true    成功
+    * @return  false   写入失败，见bufferPool::flush
+    */
+    bool save() {
+        if (hashed) {
+            return h.save();
+        }
+        bool ok = t.save();
+        return bloom.save() && ok;
+    }
+
+    /**
+    * @brief   删除索引文件
+    */
+    void drop() {
+        pool().discard(filename);
+        std::remove(filename.c_str());
+        bloom.drop();
+    }
+};
+}
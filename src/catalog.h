@@ -0,0 +1,292 @@
+/**
+ * @file        catalog.h
+ * @brief       模式目录
+ *              每个数据库在首次访问时读取其全部.prof并常驻内存，之后语句执行不再读取.prof
+ *              create table、create index、drop table、drop database及表选项的修改同步更新目录
+ * @author      hjb
+ * @version     1.0
+ * @date        2023-12-10
+ * @copyright   Copyright (c) 2023
+ */
+
+#pragma once
+
+#include "bpTree/dataMgr.h"
+#include "utility.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief   二级索引的模式信息
+ */
+struct indexSchema {
+    std::string name;           // 索引名
+    std::vector<int> columns;   // 属性下标
+    bool hashed = false;        // 是否为hash索引
+};
+
+/**
+ * @brief   表的模式信息
+ */
+struct tableSchema {
+    int keyType = -1;           // 主键类型，0为int，1为string
+    int primaryKey = 0;         // 主键在属性列表中位置，组合主键时为首个主键属性
+    std::vector<int> keyColumns;    // 主键属性下标，多于一个时为组合主键
+    tPropTypeList_t props;      // 属性列表
+    int options = 0;            // 表选项，见bpT::optAutoVacuum、bpT::optColumnStore
+    std::vector<indexSchema> indexes;   // 二级索引
+    std::string profFilename;   // .prof文件路径
+    std::string dataFilename;   // .dat文件路径
+};
+
+/**
+ * @brief   模式目录
+ */
+class catalog {
+private:
+    std::map<std::string, std::map<std::string, tableSchema>> databases; // 已加载的数据库
+
+public:
+    /**
+     * @brief   数据库是否存在，未加载时从磁盘加载
+     * @param   database    数据库名
+     * @return  true
+     * @return  false
+     */
+    bool hasDatabase(const std::string &database) {
+        return load(database) != nullptr;
+    }
+
+    /**
+     * @brief   查找表的模式信息
+     * @param   database    数据库名
+     * @param   tablename   表名
+     * @return  const tableSchema*  表不存在时为nullptr
+     */
+    const tableSchema *find(const std::string &database, const std::string &tablename) {
+        auto db = load(database);
+        if (db == nullptr) {
+            return nullptr;
+        }
+        auto itr = db->find(tablename);
+        return itr == db->end() ? nullptr : &itr->second;
+    }
+
+    /**
+     * @brief   登记新建的表，重新读取其.prof
+     * @param   database    数据库名
+     * @param   tablename   表名
+     */
+    void put(const std::string &database, const std::string &tablename) {
+        auto db = load(database);
+        tableSchema s;
+        if (db != nullptr && readProf(database, tablename, s)) {
+            (*db)[tablename] = s;
+        }
+    }
+
+    /**
+     * @brief   修改表选项
+     * @param   database    数据库名
+     * @param   tablename   表名
+     * @param   options     表选项
+     */
+    void setOptions(const std::string &database, const std::string &tablename, int options) {
+        auto db = load(database);
+        if (db != nullptr && db->contains(tablename)) {
+            (*db)[tablename].options = options;
+        }
+    }
+
+    /**
+     * @brief   修改表的二级索引列表
+     * @param   database    数据库名
+     * @param   tablename   表名
+     * @param   indexes     二级索引
+     */
+    void setIndexes(const std::string &database, const std::string &tablename,
+                    const std::vector<indexSchema> &indexes) {
+        auto db = load(database);
+        if (db != nullptr && db->contains(tablename)) {
+            (*db)[tablename].indexes = indexes;
+        }
+    }
+
+    /**
+     * @brief   删除表的模式信息
+     * @param   database    数据库名
+     * @param   tablename   表名
+     */
+    void erase(const std::string &database, const std::string &tablename) {
+        auto itr = databases.find(database);
+        if (itr != databases.end()) {
+            itr->second.erase(tablename);
+        }
+    }
+
+    /**
+     * @brief   卸载数据库，下次访问时重新从磁盘加载
+     * @param   database    数据库名
+     */
+    void drop(const std::string &database) {
+        databases.erase(database);
+    }
+
+private:
+    /**
+     * @brief   加载数据库中全部表的模式信息
+     * @param   database    数据库名
+     * @return  std::map<std::string, tableSchema>*  数据库不存在时为nullptr
+     */
+    std::map<std::string, tableSchema> *load(const std::string &database) {
+        auto itr = databases.find(database);
+        if (itr != databases.end()) {
+            return &itr->second;
+        }
+        std::string dbPath = bpT::dataPos + database;
+        if (database.empty() || !std::filesystem::is_directory(dbPath)) {
+            return nullptr;
+        }
+        auto &db = databases[database];
+        for (auto &entry : std::filesystem::directory_iterator(dbPath)) {
+            if (entry.path().extension() != ".prof") {
+                continue;
+            }
+            std::string tablename = entry.path().stem().string();
+            tableSchema s;
+            if (readProf(database, tablename, s)) {
+                db[tablename] = s;
+            }
+        }
+        return &db;
+    }
+
+    /**
+     * @brief   读取.prof
+     *          xxxx xxxx xxxx  主键类型 主键位置 属性个数
+     *          x ...  各属性类型
+     *          ...    属性名，以空格分隔，以'\0'结尾
+     *          偏移maxPropSize处：xxxx  格式标记bpT::profMark，不符时不识别该表
+     *          其后：xxxx  表选项
+     *          其后：xxxx  二级索引个数，每个索引为 xxxx 属性下标 及以'\0'结尾的索引名，
+     *                多属性索引及hash索引的属性下标处为 -(属性个数 | hash索引 << 16)，其后依次为各属性下标
+     *          其后：xxxx  组合主键的属性个数，及 xxxx ... 各主键属性下标，单属性主键时无此项
+     * @param   database    数据库名
+     * @param   tablename   表名
+     * @param   s           输出
+     * @return  true        成功
+     * @return  false       文件不存在、不完整或格式不符
+     */
+    static bool readProf(const std::string &database, const std::string &tablename, tableSchema &s) {
+        s.profFilename = bpT::dataPos + database + "/" + tablename + ".prof";
+        s.dataFilename = bpT::dataPos + database + "/" + tablename + ".dat";
+        std::ifstream fi(s.profFilename, std::ios::in | std::ios::binary);
+        if (!fi) {
+            return false;
+        }
+        int _propNums = 0;
+        fi.read((char *)&s.keyType, 4);
+        fi.read((char *)&s.primaryKey, 4);
+        fi.read((char *)&_propNums, 4);
+        if (!fi || _propNums <= 0) {
+            return false;
+        }
+        std::vector<char> _propType(_propNums);
+        fi.read(_propType.data(), _propNums);
+        std::vector<std::string> _propName(_propNums);
+        for (auto i = 0; i < _propNums - 1; ++i) {
+            getline(fi, _propName[i], ' ');
+        }
+        getline(fi, _propName.back(), (char)0);
+        for (auto i = 0; i < _propNums; ++i) {
+            s.props.push_back(tPropType_t {_propName[i], _propType[i]});
+        }
+        s.keyColumns = {s.primaryKey};
+        uint32_t _mark = 0;
+        fi.seekg(bpT::maxPropSize, std::ios::beg);
+        fi.read((char *)&_mark, 4);
+        if (!fi || _mark != bpT::profMark) {
+            std::cout << "Unsupported table format: " << s.profFilename << std::endl;
+            return false;
+        }
+        fi.read((char *)&s.options, 4);
+        if (fi.gcount() != 4) {
+            s.options = 0;
+            return true;
+        }
+        auto readColumns = [&](int n, std::vector<int> &cols) {
+            for (auto i = 0; fi && i < n; ++i) {
+                int _column = -1;
+                fi.read((char *)&_column, 4);
+                cols.push_back(_column);
+            }
+            for (auto i : cols) {
+                if (i < 0 || i >= _propNums) {
+                    return false;
+                }
+            }
+            return fi && !cols.empty();
+        };
+        int _indexNums = 0;
+        fi.read((char *)&_indexNums, 4);
+        for (auto i = 0; fi && i < _indexNums; ++i) {
+            int _column = 0;
+            std::vector<int> _cols;
+            std::string _name;
+            fi.read((char *)&_column, 4);
+            bool _valid = _column < 0 ? readColumns(-_column & 0xffff, _cols) : (_cols.push_back(_column), true);
+            getline(fi, _name, (char)0);
+            if (fi && _valid && _cols[0] < _propNums) {
+                s.indexes.push_back(indexSchema {_name, _cols, _column < 0 && (-_column >> 16) == 1});
+            }
+        }
+        int _keyNums = 0;
+        std::vector<int> _keys;
+        fi.read((char *)&_keyNums, 4);
+        if (fi && _keyNums > 1 && readColumns(_keyNums, _keys)) {
+            s.keyColumns = _keys;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief   全局模式目录
+ * @return  catalog&
+ */
+inline catalog &schemas() {
+    static catalog c;
+    return c;
+}
+
+/**
+ * @brief   检测数据库是否存在
+ * @param   database
+ * @return  true
+ * @return  false
+ */
+inline bool searchDatabase(const std::string database) {
+    if (!schemas().hasDatabase(database)) {
+        std::cout << "Database not exists!" << std::endl;
+        return false;
+    } else
+        return true;
+}
+
+/**
+ * @brief   检测表是否存在
+ * @param   database
+ * @param   tablename
+ * @return  true
+ * @return  false
+ */
+inline bool searchTable(const std::string database, const std::string tablename) {
+    if (schemas().find(database, tablename) == nullptr) {
+        std::cout << "Table not exists!" << std::endl;
+        return false;
+    } else
+        return true;
+}
@@ -10,6 +10,8 @@
 #pragma once
 
 #include "bpTree/bpTree.h"
+#include "bpTree/secondaryIndex.h"
+#include "catalog.h"
 #include <filesystem>
 #include <fstream>
 #include <string>
@@ -25,77 +27,154 @@ private:
     std::string dataFilename;                // .dat文件路径
     std::string profFilename;                // .prof文件路径
     tPropTypeList_t props;   // 表的属性列表
+    bpT::rowLayout layout;   // 表的行布局
+    int options = 0;         // 表选项，见bpT::optAutoVacuum、bpT::optColumnStore
     bpT::bpTree<T> t;                        // 表索引结构
+    std::vector<bpT::secondaryIndex> indexes;   // 二级索引
 
 protected:
     /**
-     * @brief   删除多个数据
-     * @param   key         主键值
+     * @brief   由属性列表生成行布局
+     */
+    void makeLayout() {
+        std::vector<char> _types;
+        for (auto &i : props) {
+            _types.push_back(i.second);
+        }
+        layout = bpT::rowLayout(_types);
+        t.dm.setLayout(layout);
+    }
+
+    /**
+     * @brief   比较结果是否满足比较运算
+     * @param   cmp     属性值与比较值的比较结果
+     * @param   oper    > : 0; < : 1; = : 2; >= : 3; <= : 4;
+     * @return  true    满足
+     * @return  false   不满足
+     */
+    static bool satisfied(int cmp, char oper) {
+        switch (oper) {
+        case 0: // >
+            return cmp > 0;
+        case 1: // <
+            return cmp < 0;
+        case 2: // =
+            return cmp == 0;
+        case 3: // >=
+            return cmp >= 0;
+        case 4: // <=
+            return cmp <= 0;
+        }
+        return true;
+    }
+
+    /**
+     * @brief   判断行是否满足全部where条件，仅读取条件涉及的属性，溢出的属性在用到时才读取
+     * @param   row         行
      * @param   conditions  where条件列表
-     * @return  true        成功
-     * @return  false       失败
+     * @param   opers       比较运算符列表
+     * @return  true        满足
+     * @return  false       不满足
      */
-    bool erase_some(std::string &_record, tCdtPosList_t &conditions,
-                    std::vector<bool> &erased, std::vector<char> &opers) {
-        if (_record == "") {
-            return false;
+    bool matched(bpT::rowView &row, tCdtPosList_t &conditions, std::vector<char> &opers) {
+        for (auto i = 0uz; i < conditions.size(); ++i) { // > : 0; < : 1; = : 2; >= : 3; <= : 4;
+            auto k = conditions[i].first;
+            int cmp = 0;
+            if (layout.isInt(k)) { // int属性按数值比较，与索引中的顺序一致
+                int _a = row.getInt(k), _b = std::atoi(conditions[i].second.c_str());
+                cmp = (_a > _b) - (_a < _b);
+            } else if (row.external(k)) {
+                cmp = t.dm.getColumn(row, k).compare(conditions[i].second);
+            } else {
+                cmp = row.getStr(k).compare(conditions[i].second);
+            }
+            if (!satisfied(cmp, opers[i])) {
+                return false;
+            }
         }
-        char _rec[_record.size()];
-        memcpy(_rec, _record.data(), _record.size());
-        int _nowPos = 0;
-        int _nowSize = 0;
-        std::vector<std::string> fullData;
-        for (auto i = 0uz; i < props.size(); ++i) {
-            if (props[i].second == 1) {
-                int _iInt = 0;
-                memcpy((char *)&_iInt, _rec + _nowPos + 4, 4);
-                fullData.push_back(std::to_string(_iInt));
-                _nowPos += 8;
+        return true;
+    }
+
+    /**
+     * @brief   判断由索引取得的属性值是否满足全部where条件
+     * @param   vals        属性值，按属性下标存放，须包含条件涉及的属性
+     * @param   conditions  where条件列表
+     * @param   opers       比较运算符列表
+     * @return  true        满足
+     * @return  false       不满足
+     */
+    bool matched(const std::vector<std::string> &vals, tCdtPosList_t &conditions, std::vector<char> &opers) {
+        for (auto i = 0uz; i < conditions.size(); ++i) {
+            auto k = conditions[i].first;
+            int cmp = 0;
+            if (layout.isInt(k)) {
+                int _a = std::atoi(vals[k].c_str()), _b = std::atoi(conditions[i].second.c_str());
+                cmp = (_a > _b) - (_a < _b);
             } else {
-                memcpy((char *)&_nowSize, _rec + _nowPos, 4);
-                char _iStr[_nowSize + 1];
-                memcpy(_iStr, _rec + _nowPos + 4, _nowSize);
-                _iStr[_nowSize] = '\0';
-                fullData.push_back(std::string(_iStr));
-                _nowPos += 4 + _nowSize;
+                cmp = vals[k].compare(conditions[i].second);
+            }
+            if (!satisfied(cmp, opers[i])) {
+                return false;
             }
         }
-        for (auto i = 0uz; i < conditions.size(); ++i) { // > : 0; < : 1; = : 2; >= : 3; <= : 4;
-            switch (opers[i]) {
-            case 0: // >
-                if (fullData[conditions[i].first] <= conditions[i].second) {
-                    return true;
-                }
-                break;
-            case 1: // <
-                if (fullData[conditions[i].first] >= conditions[i].second) {
-                    return true;
-                }
-                break;
-            case 2: // =
-                if (fullData[conditions[i].first] != conditions[i].second) {
-                    return true;
-                }
-                break;
-            case 3: // >=
-                if (fullData[conditions[i].first] < conditions[i].second) {
-                    return true;
-                }
-                break;
-            case 4: // <=
-                if (fullData[conditions[i].first] > conditions[i].second) {
-                    return true;
-                }
-                break;
+        return true;
+    }
+
+    /**
+     * @brief   语句用到的属性，列存表只读取这些属性
+     * @param   properties  读取属性列表
+     * @param   conditions  where条件列表
+     * @return  std::vector<int>    属性下标，均为空时为主键
+     */
+    std::vector<int> usedColumns(const std::vector<int> &properties, const tCdtPosList_t &conditions) {
+        std::vector<int> _cols(properties);
+        for (auto &i : conditions) {
+            _cols.push_back(i.first);
+        }
+        if (_cols.empty()) {
+            _cols.push_back(primaryKey);
+        }
+        return _cols;
+    }
+
+    /**
+     * @brief   string属性上的等值条件，列存表在页内直接判断（字典编码的页比较编码），int属性按字符串比较故不下推
+     * @param   conditions  where条件列表
+     * @param   opers       比较运算符列表
+     * @return  std::vector<std::pair<int, std::string>>
+     */
+    std::vector<std::pair<int, std::string>> equalConditions(const tCdtPosList_t &conditions,
+                                                             const std::vector<char> &opers) {
+        std::vector<std::pair<int, std::string>> _eqs;
+        for (auto i = 0uz; i < conditions.size(); ++i) {
+            if (opers[i] == 2 && !layout.isInt(conditions[i].first)) {
+                _eqs.push_back(conditions[i]);
             }
         }
-        erased.back() = true;
+        return _eqs;
+    }
+
+    /**
+     * @brief   删除多个数据
+     * @param   _record     行数据
+     * @param   conditions  where条件列表
+     * @param   erased      是否删除
+     * @return  true        成功
+     * @return  false       失败
+     */
+    bool erase_some(std::string_view _record, tCdtPosList_t &conditions,
+                    std::vector<bool> &erased, std::vector<char> &opers) {
+        if (_record.empty()) {
+            return false;
+        }
+        bpT::rowView row(_record, layout);
+        erased.back() = matched(row, conditions, opers);
         return true;
     }
 
     /**
      * @brief   读取多个数据
-     * @param   key         主键值
+     * @param   _record     行数据
      * @param   widths      属性最大数据长度
      * @param   properties  读取属性列表
      * @param   datas       输出数据
@@ -103,147 +182,424 @@ protected:
      * @return  true        成功
      * @return  false       失败
      */
-    inline bool read_some(std::string &_record, std::vector<int> &widths, std::vector<int> &properties,
+    inline bool read_some(std::string_view _record, std::vector<int> &widths, std::vector<int> &properties,
                           printData_t &datas, tCdtPosList_t &conditions, std::vector<char> &opers) {
-        if (_record == "") {
+        if (_record.empty()) {
             return false;
         }
-        char _rec[_record.size()];
-        memcpy(_rec, _record.data(), _record.size());
-        int _nowPos = 0;
-        int _nowSize = 0;
-        std::vector<std::string> fullData;
-        for (auto i = 0uz; i < props.size(); ++i) {
-            if (props[i].second == 1) {
-                int _iInt = 0;
-                memcpy((char *)&_iInt, _rec + _nowPos + 4, 4);
-                fullData.push_back(std::to_string(_iInt));
-                _nowPos += 8;
-            } else {
-                memcpy((char *)&_nowSize, _rec + _nowPos, 4);
-                char _iStr[_nowSize + 1];
-                memcpy(_iStr, _rec + _nowPos + 4, _nowSize);
-                _iStr[_nowSize] = '\0';
-                fullData.push_back(std::string(_iStr));
-                _nowPos += 4 + _nowSize;
-            }
+        bpT::rowView row(_record, layout);
+        if (!matched(row, conditions, opers)) {
+            return true;
         }
-        for (auto i = 0uz; i < conditions.size(); ++i) { // > : 0; < : 1; = : 2; >= : 3; <= : 4;
-            switch (opers[i]) {
-            case 0: // >
-                if (fullData[conditions[i].first] <= conditions[i].second) {
-                    return true;
-                }
-                break;
-            case 1: // <
-                if (fullData[conditions[i].first] >= conditions[i].second) {
+        datas.push_back(std::vector<std::string> {});
+        auto &data = datas.back();
+        for (auto i = 0uz; i < properties.size(); ++i) {
+            data.push_back(t.dm.getColumn(row, properties[i]));
+            widths[i] = std::max(widths[i], (int)data.back().size());
+        }
+        return true;
+    }
+
+    /**
+     * @brief   语句涉及的属性均为主键属性或均在同一个b+树二级索引中时，只沿索引的叶子节点作答，不读取数据文件
+     * @param   widths      属性最大数据宽度
+     * @param   properties  读取属性列表
+     * @param   datas       输出数据
+     * @param   conditions  where条件列表
+     * @param   opers       比较运算符列表
+     * @return  true        已作答
+     * @return  false       没有包含全部属性的索引
+     */
+    bool indexOnly(std::vector<int> &widths, std::vector<int> &properties, printData_t &datas,
+                   tCdtPosList_t &conditions, std::vector<char> &opers) {
+        auto _cols = usedColumns(properties, conditions);
+        auto covers = [&](const std::vector<int> &columns) {
+            return std::all_of(_cols.begin(), _cols.end(), [&](int i) {
+                return std::find(columns.begin(), columns.end(), i) != columns.end();
+            });
+        };
+        std::vector<std::string> _vals(props.size()), _decoded;
+        auto take = [&]() {
+            if (!matched(_vals, conditions, opers)) {
+                return;
+            }
+            datas.push_back(std::vector<std::string> {});
+            auto &data = datas.back();
+            for (auto i = 0uz; i < properties.size(); ++i) {
+                data.push_back(_vals[properties[i]]);
+                widths[i] = std::max(widths[i], (int)data.back().size());
+            }
+        };
+        // 主键
+        if (covers(keyColumns)) {
+            if constexpr (keyTypeIsString<T>) {
+                if (keyColumns.size() > 1) {
+                    bpT::keyCodec _codec {keyColumns, columnIsInt(keyColumns)};
+                    auto _pk = _codec.plan(conditions, opers);
+                    t.scanEntries(_pk.lo, [&](const std::string &k, int) {
+                        if (!_pk.contains(k)) {
+                            return false;
+                        }
+                        _codec.decode(k, _decoded);
+                        for (auto i = 0uz; i < keyColumns.size(); ++i) {
+                            _vals[keyColumns[i]] = _decoded[i];
+                        }
+                        take();
+                        return true;
+                    });
                     return true;
                 }
-                break;
-            case 2: // =
-                if (fullData[conditions[i].first] != conditions[i].second) {
-                    return true;
+            }
+            std::vector<typename decltype(t)::key_type> keys;
+            std::vector<int> poses;
+            auto _pkCdt = std::find_if(conditions.begin(), conditions.end(),
+                                       [&](auto &i) { return i.first == primaryKey; });
+            if (_pkCdt != conditions.end()) {
+                t.find_keys(keyFormatConverter<typename decltype(t)::key_type>(_pkCdt->second)(), keys, poses,
+                            opers[_pkCdt - conditions.begin()]);
+            } else {
+                t.find_keys(keys, poses);
+            }
+            for (auto &k : keys) {
+                if constexpr (keyTypeIsString<T>) {
+                    _vals[primaryKey] = k;
+                } else {
+                    _vals[primaryKey] = std::to_string(k);
                 }
-                break;
-            case 3: // >=
-                if (fullData[conditions[i].first] < conditions[i].second) {
-                    return true;
+                take();
+            }
+            return true;
+        }
+        // 二级索引，hash索引不保存属性值
+        for (auto &idx : indexes) {
+            if (idx.hashed || !covers(idx.columns())) {
+                continue;
+            }
+            std::vector<int> poses;
+            std::vector<std::string> keys;
+            idx.find(idx.codec.plan(conditions, opers), poses, &keys);
+            for (auto i = 0uz; i < keys.size(); ++i) {
+                if (!idx.codec.decode(keys[i], _decoded)) { // 属性值可能被截去
+                    std::string _record;
+                    t.dm.readRecord(_record, poses[i]);
+                    read_some(_record, widths, properties, datas, conditions, opers);
+                    continue;
                 }
-                break;
-            case 4: // <=
-                if (fullData[conditions[i].first] > conditions[i].second) {
-                    return true;
+                for (auto j = 0uz; j < _decoded.size(); ++j) {
+                    _vals[idx.columns()[j]] = _decoded[j];
                 }
-                break;
+                take();
             }
+            return true;
         }
-        datas.push_back(std::vector<std::string> {});
-        auto &data = datas.back();
-        for (auto i = 0uz; i < properties.size(); ++i) {
-            data.push_back(fullData[properties[i]]);
-            widths[i] = std::max(widths[i], (int)data.back().size());
-        }
-        return true;
+        return false;
     }
 
     /**
      * @brief   更新多个数据
-     * @param   key     主键值
+     * @param   _record     行数据
+     * @param   _content    更新后的行，不满足条件时为空
      * @param   setCdt      set属性列表
      * @param   conditions  where条件列表
      * @return  true        成功
      * @return  false       失败
      */
-    bool update_some(std::string &_record, std::string &_content, tCdtPos_t &setCdt,
+    bool update_some(std::string_view _record, std::string &_content, tCdtPos_t &setCdt,
                      tCdtPosList_t &conditions, std::vector<char> &opers) {
-        if (_record == "") {
+        if (_record.empty()) {
             return false;
         }
-        char _rec[_record.size()];
-        memcpy(_rec, _record.data(), _record.size());
-        int _nowPos = 0;
-        int _nowSize = 0;
-        std::vector<std::string> fullData;
-        for (auto i = 0uz; i < props.size(); ++i) {
-            if (props[i].second == 1) {
-                int _iInt = 0;
-                memcpy((char *)&_iInt, _rec + _nowPos + 4, 4);
-                fullData.push_back(std::to_string(_iInt));
-                _nowPos += 8;
-            } else {
-                memcpy((char *)&_nowSize, _rec + _nowPos, 4);
-                char _iStr[_nowSize + 1];
-                memcpy(_iStr, _rec + _nowPos + 4, _nowSize);
-                _iStr[_nowSize] = '\0';
-                fullData.push_back(std::string(_iStr));
-                _nowPos += 4 + _nowSize;
+        bpT::rowView row(_record, layout);
+        if (!matched(row, conditions, opers)) {
+            return true;
+        }
+        _content = t.dm.setColumn(_record, setCdt.first, setCdt.second);
+        return true;
+    }
+
+    /**
+     * @brief   二级索引涉及的属性
+     * @return  std::vector<int>
+     */
+    std::vector<int> indexColumns() {
+        std::vector<int> _cols;
+        for (auto &i : indexes) {
+            _cols.insert(_cols.end(), i.columns().begin(), i.columns().end());
+        }
+        return _cols;
+    }
+
+    /**
+     * @brief   各属性是否为int
+     * @param   columns 属性下标
+     * @return  std::vector<bool>
+     */
+    std::vector<bool> columnIsInt(const std::vector<int> &columns) {
+        std::vector<bool> _ints;
+        for (auto i : columns) {
+            _ints.push_back(layout.isInt(i));
+        }
+        return _ints;
+    }
+
+    /**
+     * @brief   选择可用于where条件的二级索引，全部属性均为等值条件的hash索引优先，其次为前导属性上等值条件多者
+     * @param   conditions  where条件列表
+     * @param   opers       比较运算符列表
+     * @param   range       输出，索引上的关键字区间
+     * @return  int         索引下标，没有可用的索引时为-1
+     */
+    int pickIndex(const tCdtPosList_t &conditions, const std::vector<char> &opers, bpT::keyRange &range) {
+        int _res = -1, _best = 0;
+        for (auto i = 0uz; i < indexes.size(); ++i) {
+            auto r = indexes[i].codec.plan(conditions, opers);
+            if (!indexes[i].usable(r)) {
+                continue;
+            }
+            int _score = indexes[i].hashed ? r.eqs * 2 + 2 : r.eqs * 2 + (r.used > r.eqs);
+            if (_score > _best) {
+                _res = i;
+                _best = _score;
+                range = r;
             }
         }
-        for (auto i = 0uz; i < conditions.size(); ++i) { // > : 0; < : 1; = : 2; >= : 3; <= : 4;
-            switch (opers[i]) {
-            case 0: // >
-                if (fullData[conditions[i].first] <= conditions[i].second) {
-                    return true;
-                }
-                break;
-            case 1: // <
-                if (fullData[conditions[i].first] >= conditions[i].second) {
-                    return true;
-                }
-                break;
-            case 2: // =
-                if (fullData[conditions[i].first] != conditions[i].second) {
-                    return true;
-                }
-                break;
-            case 3: // >=
-                if (fullData[conditions[i].first] < conditions[i].second) {
-                    return true;
-                }
-                break;
-            case 4: // <=
-                if (fullData[conditions[i].first] > conditions[i].second) {
+        return _res;
+    }
+
+    /**
+     * @brief   经组合主键或二级索引定位行，按rid顺序读取数据文件，结果为条件的超集，需再按条件过滤
+     * @param   conditions  where条件列表
+     * @param   opers       比较运算符列表
+     * @param   keys        输出，主键，withKeys为false时不输出
+     * @param   reses       输出，行数据
+     * @param   poses       输出，rid
+     * @param   filter      列存表下推的属性裁剪与等值条件
+     * @param   withKeys    是否输出主键，经二级索引定位时由行数据取得，filter须包含主键属性
+     * @return  true        成功
+     * @return  false       条件不涉及组合主键的首个属性，也没有可用的二级索引
+     */
+    bool rangeScan(const tCdtPosList_t &conditions, const std::vector<char> &opers,
+                   std::vector<typename decltype(t)::key_type> &keys, std::vector<std::string_view> &reses,
+                   std::vector<int> &poses, const bpT::scanFilter &filter, bool withKeys = false) {
+        bpT::keyRange r;
+        int ix = pickIndex(conditions, opers, r);
+        if constexpr (keyTypeIsString<T>) {
+            auto _pk = bpT::keyCodec {keyColumns, columnIsInt(keyColumns)}.plan(conditions, opers);
+            if (keyColumns.size() > 1 && _pk.used > 0 && (ix == -1 || !indexes[ix].hashed)) {
+                t.scanEntries(_pk.lo, [&](const std::string &k, int rid) {
+                    if (!_pk.contains(k)) {
+                        return false;
+                    }
+                    keys.push_back(k);
+                    poses.push_back(rid);
                     return true;
-                }
-                break;
+                });
+                reses.resize(poses.size());
+                t.dm.readRecord(reses, poses, filter);
+                return true;
             }
         }
-        fullData[setCdt.first] = setCdt.second;
-        std::string content = "";
-        for (auto i : fullData) {
-            content += (i + ",");
+        if (ix == -1) {
+            return false;
         }
-        if (content.back() == ',') {
-            content.pop_back();
+        indexes[ix].find(r, poses);
+        std::sort(poses.begin(), poses.end());
+        reses.resize(poses.size());
+        t.dm.readRecord(reses, poses, filter);
+        for (auto i = 0uz; withKeys && i < reses.size(); ++i) {
+            keys.push_back(reses[i].empty() ? typename decltype(t)::key_type {}
+                                            : t.rowKey(bpT::rowView(reses[i], layout)));
         }
-        _content = content;
         return true;
     }
 
+    /**
+     * @brief   where条件能否经hash索引查找，此时主键上的等值条件也改由hash索引查找
+     * @param   conditions  where条件列表
+     * @param   opers       比较运算符列表
+     * @return  true
+     * @return  false
+     */
+    bool hashCovered(const tCdtPosList_t &conditions, const std::vector<char> &opers) {
+        bpT::keyRange r;
+        int ix = pickIndex(conditions, opers, r);
+        return ix > -1 && indexes[ix].hashed;
+    }
+
+    /**
+     * @brief   行在二级索引中的属性值编码
+     * @param   idx
+     * @param   row
+     * @return  std::string
+     */
+    std::string indexKey(const bpT::secondaryIndex &idx, const bpT::rowView &row) {
+        std::vector<std::string> _vals;
+        for (auto i : idx.columns()) {
+            _vals.push_back(t.dm.getColumn(row, i));
+        }
+        return idx.encode(_vals);
+    }
+
+    /**
+     * @brief   在全部二级索引中加入或删除一行的索引项
+     * @param   _record 行数据
+     * @param   rid
+     * @param   add     true为加入，false为删除
+     */
+    void indexRow(std::string_view _record, int rid, bool add) {
+        if (_record.empty()) {
+            return;
+        }
+        bpT::rowView row(_record, layout);
+        for (auto &i : indexes) {
+            if (add) {
+                i.insert(indexKey(i, row), rid);
+            } else {
+                i.erase(indexKey(i, row), rid);
+            }
+        }
+    }
+
+    /**
+     * @brief   update修改了索引属性时，以新值替换被修改行的索引项
+     * @param   reses       原行数据
+     * @param   contents    新行数据，为空表示未修改
+     * @param   poses       rid
+     * @param   column      被修改的属性下标
+     */
+    void reindex(const std::vector<std::string_view> &reses, const std::vector<std::string> &contents,
+                 const std::vector<int> &poses, int column) {
+        std::vector<bpT::secondaryIndex *> _used;
+        for (auto &i : indexes) {
+            if (std::find(i.columns().begin(), i.columns().end(), column) != i.columns().end()) {
+                _used.push_back(&i);
+            }
+        }
+        if (_used.empty()) {
+            return;
+        }
+        for (auto i = 0uz; i < contents.size(); ++i) {
+            if (contents[i].empty()) {
+                continue;
+            }
+            bpT::rowView _old(reses[i], layout), _new(contents[i], layout);
+            for (auto j : _used) {
+                j->erase(indexKey(*j, _old), poses[i]);
+                j->insert(indexKey(*j, _new), poses[i]);
+            }
+        }
+        saveIndexes();
+    }
+
+    /**
+     * @brief   update修改了主键属性时，在主键索引中以新主键替换被修改行的原主键
+     * @param   reses       原行数据
+     * @param   contents    新行数据，为空表示未修改
+     * @param   poses       rid
+     * @param   column      被修改的属性下标
+     * @return  true        成功
+     * @return  false       新主键冲突，未作修改
+     */
+    bool rekey(const std::vector<std::string_view> &reses, const std::vector<std::string> &contents,
+               const std::vector<int> &poses, int column) {
+        if (std::find(keyColumns.begin(), keyColumns.end(), column) == keyColumns.end()) {
+            return true;
+        }
+        std::vector<typename decltype(t)::key_type> _olds, _news;
+        std::vector<int> _poses;
+        for (auto i = 0uz; i < contents.size(); ++i) {
+            if (contents[i].empty()) {
+                continue;
+            }
+            _olds.push_back(t.rowKey(bpT::rowView(reses[i], layout)));
+            _news.push_back(t.rowKey(bpT::rowView(contents[i], layout)));
+            _poses.push_back(poses[i]);
+        }
+        if (_olds.empty() || t.rekey(_olds, _news, _poses)) {
+            t.save();
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief   由数据文件批量重建二级索引
+     * @param   idx
+     */
+    void buildIndex(bpT::secondaryIndex &idx) {
+        std::vector<std::pair<std::string, int>> _vals;
+        t.dm.scanRecords([&](int rid, const bpT::rowView &row) {
+            _vals.emplace_back(indexKey(idx, row), rid);
+        });
+        idx.build(_vals);
+        idx.save();
+    }
+
+    /**
+     * @brief   将二级索引的脏页写回磁盘
+     */
+    void saveIndexes() {
+        for (auto &i : indexes) {
+            i.save();
+        }
+    }
+
+    /**
+     * @brief   将二级索引列表及组合主键写入.prof
+     */
+    void writeIndexes() {
+        std::vector<indexSchema> _list;
+        std::fstream fi(profFilename, std::ios::in | std::ios::out | std::ios::binary);
+        fi.seekp(bpT::maxPropSize + 8, std::ios::beg);
+        int _indexNums = indexes.size();
+        fi.write((char *)&_indexNums, 4);
+        for (auto &i : indexes) {
+            auto &_cols = i.columns();
+            int _colNums = -(int)(_cols.size() | (i.hashed ? 1 << 16 : 0));
+            if (_cols.size() > 1 || i.hashed) {
+                fi.write((char *)&_colNums, 4);
+            }
+            fi.write((char *)_cols.data(), _cols.size() * 4);
+            fi.write(i.name.c_str(), i.name.size() + 1);
+            _list.push_back(indexSchema {i.name, _cols, i.hashed});
+        }
+        if (keyColumns.size() > 1) {
+            int _keyNums = keyColumns.size();
+            fi.write((char *)&_keyNums, 4);
+            fi.write((char *)keyColumns.data(), keyColumns.size() * 4);
+        }
+        fi.close();
+        schemas().setIndexes(database, name, _list);
+    }
+
+    /**
+     * @brief   设置表选项并写入.prof
+     * @param   opt     选项位
+     * @param   on
+     */
+    void setOption(int opt, bool on) {
+        options = on ? (options | opt) : (options & ~opt);
+        std::fstream fi(profFilename, std::ios::in | std::ios::out | std::ios::binary);
+        fi.seekp(bpT::maxPropSize + 4, std::ios::beg);
+        fi.write((char *)&options, 4);
+        fi.close();
+        schemas().setOptions(database, name, options);
+    }
+
+    /**
+     * @brief   开启自动vacuum时，空闲空间超过vacuumRatio则重写数据文件
+     */
+    void vacuumIfNeeded() {
+        if ((options & bpT::optAutoVacuum) && t.dm.freeRatio() > bpT::vacuumRatio) {
+            vacuumTable();
+        }
+    }
+
 public:
     std::string database = ""; // 数据库名
     std::string name = "";  // 表名
-    int primaryKey = 0;     // 主键在属性列表中位置
+    int primaryKey = 0;     // 主键在属性列表中位置，组合主键时为首个主键属性
+    std::vector<int> keyColumns;    // 主键属性下标，多于一个时为组合主键
 
     table() = default;
     table(std::string const database, std::string const tablename) noexcept {
@@ -257,46 +613,60 @@ public:
         this->dataFilename = bpT::dataPos + database + "/" + tablename + ".dat";
         this->profFilename = bpT::dataPos + database + "/" + tablename + ".prof";
 
-        if (std::filesystem::exists(profFilename)) {
-            std::ifstream fi(profFilename, std::ios::in | std::ios::binary);
-            fi.seekg(4, std::ios::beg);
-            fi.read((char *)&primaryKey, 4);
-            int _propNums = 0;
-            fi.read((char *)&_propNums, 4);
-            char _propType[_propNums];
-            fi.read(_propType, sizeof(_propType));
-            std::vector<std::string> _propName = {""};
-            for (auto i = 0; i < _propNums - 1; ++i) {
-                getline(fi, _propName[i], ' ');
-                _propName.push_back("");
-            }
-            getline(fi, _propName.back(), (char)0);
-            for (auto i = 0; i < _propNums; ++i) {
-                props.push_back(tPropType_t {_propName[i], _propType[i]});
+        auto _schema = schemas().find(database, tablename);
+        if (_schema != nullptr) {
+            primaryKey = _schema->primaryKey;
+            keyColumns = _schema->keyColumns;
+            props = _schema->props;
+            options = _schema->options;
+            t.dm.setColumnar(options & bpT::optColumnStore);
+            makeLayout();
+            t.setKeyColumns(keyColumns, columnIsInt(keyColumns));
+            t.setBloom(true);
+            indexes.clear();
+            for (auto &i : _schema->indexes) {
+                indexes.emplace_back();
+                indexes.back().init(database, tablename, i.name, i.columns, columnIsInt(i.columns), i.hashed);
             }
-            fi.close();
         }
     }
 
     void renew() {
         this->primaryKey = 0;
+        this->keyColumns.clear();
         this->props.clear();
+        this->layout = bpT::rowLayout {};
+        this->options = 0;
+        this->t.setKeyColumns({}, {});
+        this->t.setBloom(false);
         this->t.clear();
+        this->indexes.clear();
     }
 
     /**
      * @brief   在磁盘上创建表
      * @param   _props  属性列表
-     * @param   pk      主键在属性列表中位置
+     * @param   pks     主键属性在属性列表中位置，多于一个时为组合主键，主键类型须为string
+     * @param   columnar    是否以PAX页按列存储
+     * @param   hashed  是否在主键上另建hash索引（名为primary），主键等值查找经hash索引
      * @return  true    成功
      * @return  false   失败
      */
-    bool createTable(tPropTypeList_t &_props, int pk = 0) {
+    bool createTable(tPropTypeList_t &_props, const std::vector<int> &pks = {0}, bool columnar = false,
+                     bool hashed = false) {
         props.clear();
-        primaryKey = pk;
+        primaryKey = pks.front();
+        keyColumns = pks;
         for (auto i : _props) {
             props.push_back(i);
         }
+        makeLayout();
+        t.setKeyColumns(keyColumns, columnIsInt(keyColumns));
+        t.setBloom(true);
+        // 目录中没有该表而.prof存在，为无法识别的旧格式表，先删除其文件
+        if (schemas().find(database, name) == nullptr && std::filesystem::exists(profFilename)) {
+            dropTable(database, name);
+        }
         std::fstream fi(profFilename, std::ios::out | std::ios::binary);
         fi.seekp(std::ios::beg);
         int keyIsInt = keyTypeIsString<T> == true ? 1 : 0;
@@ -322,21 +692,38 @@ public:
         memcpy(_writeIn, _propName.data(), _propName.size());
         fi.write(_propType, sizeof(_propType));
         fi.write(_writeIn, sizeof(_writeIn));
+        fi.seekp(bpT::maxPropSize, std::ios::beg);
+        fi.write((char *)&bpT::profMark, 4);
 
         fi.close();
 
-        t.init(database, name, bpT::bpTreeLevel);
+        t.init(database, name);
 
         t.recordInit();
+        setOption(bpT::optColumnStore, columnar);
+        t.dm.setColumnar(columnar);
+        indexes.clear();
+        if (hashed) {
+            indexes.emplace_back();
+            indexes.back().init(database, name, "primary", keyColumns, columnIsInt(keyColumns), true);
+            buildIndex(indexes.back());
+        }
+        writeIndexes();
+        schemas().put(database, name);
 
         return true;
     }
 
     /**
-     * @brief   使用磁盘数据初始化内存中的表对象
+     * @brief   使用磁盘数据初始化内存中的表对象，缺失的二级索引由数据文件重建
      */
     void openTable() {
-        t.init(database, name, bpT::bpTreeLevel);
+        t.init(database, name);
+        for (auto &i : indexes) {
+            if (!i.exists()) {
+                buildIndex(i);
+            }
+        }
     }
 
     /**
@@ -348,25 +735,75 @@ public:
         for (auto i : _props) {
             props.push_back(i);
         }
+        makeLayout();
 
-        t.init(database, name, bpT::bpTreeLevel);
+        t.init(database, name);
     }
 
     /**
-     * @brief   获得主键在属性列表中位置
-     * @return  int 主键在属性列表中位置
+     * @brief   由insert的常量列表取得主键，组合主键为各主键属性的保序编码
+     * @param   data    常量列表
+     * @param   key     输出，主键
+     * @return  true    成功
+     * @return  false   常量个数不足
      */
-    int getPrimaryKey() {
-        return primaryKey;
+    bool keyOf(const std::vector<tRow> &data, typename decltype(t)::key_type &key) {
+        for (auto i : keyColumns) {
+            if (i >= (int)data.size()) {
+                return false;
+            }
+        }
+        if constexpr (keyTypeIsString<T>) {
+            if (keyColumns.size() > 1) {
+                std::vector<std::string> _vals;
+                for (auto i : keyColumns) {
+                    _vals.push_back(data[i].type == INT ? std::to_string(data[i].i_value) : data[i].s_value);
+                }
+                key = bpT::keyCodec {keyColumns, columnIsInt(keyColumns)}.encode(_vals);
+            } else {
+                key = data[primaryKey].s_value;
+            }
+        } else {
+            key = data[primaryKey].i_value;
+        }
+        return true;
     }
 
     /**
      * @brief   插入数据
      * @param   v   主键值
+     * @return  true    成功
+     * @return  false   主键过长或数据与表结构不符，未作修改
+     */
+    bool insertTable(decltype(t)::keyValue v) {
+        if (indexes.empty()) {
+            int rid = t.insert(v);
+            t.save();
+            return rid >= 0;
+        }
+        std::string _old = t.find(v.key);
+        int rid = t.insert(v);
+        if (rid >= 0) {
+            std::string _new;
+            t.dm.readRecord(_new, rid);
+            indexRow(_old, rid, false);
+            indexRow(_new, rid, true);
+            saveIndexes();
+        }
+        t.save();
+        return rid >= 0;
+    }
+
+    /**
+     * @brief   批量导入数据，导入后批量重建索引
+     * @param   vs  键值对
      */
-    void insertTable(decltype(t)::keyValue v) {
-        t.insert(v);
+    void loadTable(std::vector<typename decltype(t)::keyValue> &vs) {
+        t.load(vs);
         t.save();
+        for (auto &i : indexes) {
+            buildIndex(i);
+        }
     }
 
     /**
@@ -380,11 +817,7 @@ public:
      */
     bool readTable(std::vector<int> &widths, std::vector<std::string> &properties, printData_t &datas,
                    tCdtNameList_t &conditions) {
-        if (t.head == nullptr)
-            return false;
-        if (t.head->leaf == nullptr)
-            return false;
-        if (t.head->leaf->vals.size() == 0)
+        if (t.empty())
             return false;
 
         std::vector<int> _props;
@@ -408,7 +841,7 @@ public:
                     opers[i] = conditions[i].second.back();
                     conditions[i].second.pop_back();
                     _cdts.emplace_back(j, conditions[i].second);
-                    if ((int)j == primaryKey) {
+                    if ((int)j == primaryKey && keyColumns.size() == 1) {
                         _pkCdt = i;
                     }
                     break;
@@ -418,6 +851,9 @@ public:
                 }
             }
         }
+        if (_pkCdt > -1 && hashCovered(_cdts, opers)) {
+            _pkCdt = -1;
+        }
         if (properties.size() == 0) {
             for (auto i = 0uz; i < props.size(); ++i) {
                 _props.push_back(i);
@@ -426,26 +862,30 @@ public:
         }
         for (auto i : _props)
             widths.push_back(props[i].first.size());
+        // 只读取索引
+        if (indexOnly(widths, _props, datas, _cdts, opers)) {
+            return true;
+        }
+        bpT::scanFilter _filter{usedColumns(_props, _cdts), equalConditions(_cdts, opers)};
         // 索引查找
         if (_pkCdt > -1) {
             typename decltype(t)::key_type _pkKey;
             _pkKey = keyFormatConverter<typename decltype(t)::key_type>(conditions[_pkCdt].second)();
-            std::vector<std::string> reses;
-            t.find_matched(_pkKey, reses, opers[_pkCdt]);
+            std::vector<std::string_view> reses;
+            t.find_matched(_pkKey, reses, opers[_pkCdt], _filter);
             for (auto &res : reses) {
                 read_some(res, widths, _props, datas, _cdts, opers);
             }
             return true;
         }
-        // 全文查找
         std::vector<typename decltype(t)::key_type> keys;
-        for (auto itr = t.head; itr != t.tail; itr = itr->next) {
-            for (auto i : itr->leaf->vals) {
-                keys.push_back(i.first);
-            }
+        std::vector<std::string_view> reses;
+        std::vector<int> poses;
+        // 组合主键或二级索引查找
+        if (!rangeScan(_cdts, opers, keys, reses, poses, _filter)) {
+            // 全文查找
+            t.find_all(keys, reses, poses, _filter);
         }
-        std::vector<std::string> reses(keys.size());
-        t.find_some(keys, reses);
         for (auto &res : reses) {
             read_some(res, widths, _props, datas, _cdts, opers);
         }
@@ -460,11 +900,7 @@ public:
      * @return  false       失败
      */
     bool updateTable(tCdtName_t &setCdt, tCdtNameList_t &conditions) {
-        if (t.head == nullptr)
-            return false;
-        if (t.head->leaf == nullptr)
-            return false;
-        if (t.head->leaf->vals.size() == 0)
+        if (t.empty())
             return false;
 
         tCdtPosList_t _cdts;
@@ -477,7 +913,7 @@ public:
                     opers[i] = conditions[i].second.back();
                     conditions[i].second.pop_back();
                     _cdts.emplace_back(j, conditions[i].second);
-                    if ((int)j == primaryKey) {
+                    if ((int)j == primaryKey && keyColumns.size() == 1) {
                         _pkCdt = i;
                     }
                     break;
@@ -487,6 +923,9 @@ public:
                 }
             }
         }
+        if (_pkCdt > -1 && hashCovered(_cdts, opers)) {
+            _pkCdt = -1;
+        }
         for (auto i = 0uz; i < props.size(); ++i) {
             if (setCdt.first == props[i].first) {
                 _setCdt.first = i;
@@ -497,35 +936,41 @@ public:
                 return false;
             }
         }
+        bpT::scanFilter _filter{{}, equalConditions(_cdts, opers)};
         // 索引查找
         if (_pkCdt > -1) {
             typename decltype(t)::key_type _pkKey;
             _pkKey = keyFormatConverter<typename decltype(t)::key_type>(conditions[_pkCdt].second)();
-            std::vector<std::string> reses;
+            std::vector<std::string_view> reses;
             std::vector<int> poses;
-            t.find_matched(_pkKey, reses, poses, opers[_pkCdt]);
+            t.find_matched(_pkKey, reses, poses, opers[_pkCdt], _filter);
             std::vector<std::string> contents(reses.size(), "");
             for (auto i = 0uz; i < reses.size(); ++i) {
                 update_some(reses[i], contents[i], _setCdt, _cdts, opers);
             }
+            if (!rekey(reses, contents, poses, _setCdt.first)) {
+                return false;
+            }
+            reindex(reses, contents, poses, _setCdt.first);
             t.update_some(contents, poses);
             return true;
         }
-        // 全文查找
         std::vector<typename decltype(t)::key_type> keys;
-        for (auto itr = t.head; itr != t.tail; itr = itr->next) {
-            for (auto i : itr->leaf->vals) {
-                keys.push_back(i.first);
-            }
+        std::vector<std::string_view> reses;
+        std::vector<int> poses;
+        // 组合主键或二级索引查找
+        if (!rangeScan(_cdts, opers, keys, reses, poses, _filter)) {
+            // 全文查找
+            t.find_all(keys, reses, poses, _filter);
         }
-        int sz = keys.size();
-        std::vector<std::string> reses(sz);
-        std::vector<std::string> contents(sz, "");
-        std::vector<int> poses(sz, -1);
-        t.find_some(keys, reses, poses);
+        std::vector<std::string> contents(reses.size(), "");
         for (auto i = 0uz; i < reses.size(); ++i) {
             update_some(reses[i], contents[i], _setCdt, _cdts, opers);
         }
+        if (!rekey(reses, contents, poses, _setCdt.first)) {
+            return false;
+        }
+        reindex(reses, contents, poses, _setCdt.first);
         t.update_some(contents, poses);
         return true;
     }
@@ -537,11 +982,7 @@ public:
      * @return  false   失败
      */
     bool eraseTable(tCdtNameList_t &conditions) {
-        if (t.head == nullptr)
-            return false;
-        if (t.head->leaf == nullptr)
-            return false;
-        if (t.head->leaf->vals.size() == 0)
+        if (t.empty())
             return false;
 
         tCdtPosList_t _cdts;
@@ -553,7 +994,7 @@ public:
                     opers[i] = conditions[i].second.back();
                     conditions[i].second.pop_back();
                     _cdts.emplace_back(j, conditions[i].second);
-                    if ((int)j == primaryKey) {
+                    if ((int)j == primaryKey && keyColumns.size() == 1) {
                         _pkCdt = i;
                     }
                     break;
@@ -563,44 +1004,107 @@ public:
                 }
             }
         }
-        // 索引查找
-        if (_pkCdt > -1) {
-            typename decltype(t)::key_type _pkKey;
-            _pkKey = keyFormatConverter<typename decltype(t)::key_type>(conditions[_pkCdt].second)();
-            std::vector<std::string> reses;
-            std::vector<int> poses;
-            std::vector<typename decltype(t)::key_type> keys;
-            t.find_matched(_pkKey, keys, reses, poses, opers[_pkCdt]);
-            int sz = poses.size();
-            std::vector<bool> eraseds;
-            for (auto i = 0; i < sz; ++i) {
-                eraseds.push_back(false);
-                erase_some(reses[i], _cdts, eraseds, opers);
-            }
-            t.erase(keys, poses, eraseds);
-            return true;
+        if (_pkCdt > -1 && hashCovered(_cdts, opers)) {
+            _pkCdt = -1;
         }
-        // 全文查找
-        std::vector<typename decltype(t)::key_type> keys;
-        for (auto itr = t.head; itr != t.tail; itr = itr->next) {
-            for (auto i : itr->leaf->vals) {
-                keys.push_back(i.first);
-            }
+        std::vector<int> _cols = indexColumns();
+        if (!_cols.empty()) {
+            _cols.insert(_cols.end(), keyColumns.begin(), keyColumns.end());
         }
-        int sz = keys.size();
-        std::vector<std::string> reses(sz);
-        std::vector<std::string> contents(sz, "");
-        std::vector<int> poses(sz, -1);
+        bpT::scanFilter _filter{usedColumns(_cols, _cdts), equalConditions(_cdts, opers)};
+        std::vector<typename decltype(t)::key_type> keys;
+        std::vector<std::string_view> reses;
+        std::vector<int> poses;
         std::vector<bool> eraseds;
-        t.find_some(keys, reses, poses);
+        if (_pkCdt > -1) { // 索引查找
+            typename decltype(t)::key_type _pkKey;
+            _pkKey = keyFormatConverter<typename decltype(t)::key_type>(conditions[_pkCdt].second)();
+            t.find_matched(_pkKey, keys, reses, poses, opers[_pkCdt], _filter);
+        } else if (!rangeScan(_cdts, opers, keys, reses, poses, _filter, true)) { // 组合主键或二级索引查找，均不可用时全文查找
+            t.find_all(keys, reses, poses, _filter);
+        }
+        int sz = poses.size();
         for (auto i = 0; i < sz; ++i) {
             eraseds.push_back(false);
             erase_some(reses[i], _cdts, eraseds, opers);
+            if (eraseds[i]) {
+                indexRow(reses[i], poses[i], false);
+            }
+        }
+        if (!indexes.empty()) {
+            saveIndexes();
         }
         t.erase(keys, poses, eraseds);
+        t.save();
+        vacuumIfNeeded();
+        return true;
+    }
+
+    /**
+     * @brief   按主键顺序重写数据文件，回收删除留下的空间
+     * @return  true    成功
+     * @return  false   失败
+     */
+    bool vacuumTable() {
+        // 二级索引中的rid在换入新数据文件后失效，先删除，中断时由openTable按数据文件重建
+        for (auto &i : indexes) {
+            i.drop();
+        }
+        bool ok = t.vacuum();
+        t.save();
+        for (auto &i : indexes) {
+            buildIndex(i);
+        }
+        return ok;
+    }
+
+    /**
+     * @brief   在一个或多个属性上创建二级索引，由现有数据批量构建并写入.prof
+     * @param   indexname   索引名
+     * @param   columns     属性名
+     * @param   hashed      是否为hash索引
+     * @return  true        成功
+     * @return  false       失败
+     */
+    bool createIndex(const std::string &indexname, const std::vector<std::string> &columns, bool hashed = false) {
+        std::vector<int> _cols;
+        for (auto &c : columns) {
+            for (auto i = 0uz; i <= props.size(); ++i) {
+                if (i == props.size()) {
+                    std::cout << "Column not exists!" << std::endl;
+                    return false;
+                }
+                if (props[i].first == c) {
+                    _cols.push_back(i);
+                    break;
+                }
+            }
+        }
+        for (auto &i : indexes) {
+            if (i.name == indexname || (i.columns() == _cols && i.hashed == hashed)) {
+                std::cout << "Index exists!" << std::endl;
+                return false;
+            }
+        }
+        if (!bpT::secondaryIndex::fits(_cols, columnIsInt(_cols), hashed)) {
+            std::cout << "Index key too long!" << std::endl;
+            return false;
+        }
+        indexes.emplace_back();
+        indexes.back().init(database, name, indexname, _cols, columnIsInt(_cols), hashed);
+        buildIndex(indexes.back());
+        writeIndexes();
         return true;
     }
 
+    /**
+     * @brief   设置delete后是否自动vacuum，并写入.prof
+     * @param   on
+     */
+    void setAutoVacuum(bool on) {
+        setOption(bpT::optAutoVacuum, on);
+    }
+
     /**
      * @brief   删除表
      * @param   database    数据库名
@@ -617,29 +1121,41 @@ public:
             std::cout << "Table not exists!" << std::endl;
             return false;
         }
+        if (auto _schema = schemas().find(database, tablename); _schema != nullptr) {
+            for (auto &i : _schema->indexes) {
+                std::string _filename = tablePos + "." + i.name + (i.hashed ? ".hash" : ".ind");
+                bpT::pool().discard(_filename);
+                remove(_filename.c_str());
+                if (!i.hashed) {
+                    _filename = tablePos + "." + i.name + ".bloom";
+                    bpT::pool().discard(_filename);
+                    remove(_filename.c_str());
+                }
+            }
+        }
+        schemas().erase(database, tablename);
+        std::string fsmFilename = tablePos + ".fsm";
+        std::string bloomFilename = tablePos + ".bloom";
+        bpT::pool().discard(dataFilename);
+        bpT::pool().discard(fsmFilename);
+        bpT::pool().discard(indexFilename);
+        bpT::pool().discard(bloomFilename);
         remove(dataFilename.c_str());
+        remove(fsmFilename.c_str());
         remove(indexFilename.c_str());
+        remove(bloomFilename.c_str());
 
         return true;
     }
 
     /**
-     * @brief   从磁盘中获取主键在属性列表中的位置
+     * @brief   从模式目录中获取主键类型
      * @param   database    数据库名
      * @param   tablename   表名
-     * @return  int         主键在属性列表中的位置
+     * @return  int         0为int，1为string，表不存在时为-1
      */
     static int getKeyType(const std::string database, const std::string tablename) {
-        std::string filename = bpT::dataPos + database + "/" + tablename + ".prof";
-        if (!std::filesystem::exists(filename)) {
-            return -1;
-        }
-        std::ifstream file(filename, std::ios::in | std::ios::binary);
-        int keyType = 0;
-        file.seekg(std::ios::beg);
-        file.read((char *)&keyType, 4);
-        file.close();
-
-        return keyType;
+        auto _schema = schemas().find(database, tablename);
+        return _schema == nullptr ? -1 : _schema->keyType;
     }
 };
\ No newline at end of file
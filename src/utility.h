@@ -44,9 +44,9 @@ inline void str_process(std::string &str) {
     // 全部转换为小写
     std::transform(str.begin(), str.end(), str.begin(), ::tolower);
     // 清理多余制表符或空格
-    std::regex tabs("\\t+");
+    static const std::regex tabs("\\t+");
     str = std::regex_replace(str, tabs, " ");
-    std::regex spaces("\\s+");
+    static const std::regex spaces("\\s+");
     str = std::regex_replace(str, spaces, " ");
     if (str.at(0) == ' ') {
         str.erase(0, 1);
@@ -133,35 +133,6 @@ inline uint8_t arithOperMatch(std::string &s, std::string &s1) {
     return 5;
 }
 
-/**
- * @brief   检测数据库是否存在
- * @param   database
- * @return  true
- * @return  false
- */
-inline bool searchDatabase(const std::string database) {
-    if (!std::filesystem::exists("data/" + database)) {
-        std::cout << "Database not exists!" << std::endl;
-        return false;
-    } else
-        return true;
-}
-
-/**
- * @brief   检测表是否存在
- * @param   database
- * @param   tablename
- * @return  true
- * @return  false
- */
-inline bool searchTable(const std::string database, const std::string tablename) {
-    if (!std::filesystem::exists("data/" + database + "/" + tablename + ".prof")) {
-        std::cout << "Table not exists!" << std::endl;
-        return false;
-    } else
-        return true;
-}
-
 /**
  * @brief   打印行线
  * @param   max_num 每列最大宽度
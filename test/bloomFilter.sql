@@ -0,0 +1,323 @@
+create database t;
+use t;
+create table b(k string primary, v int);
+create index bv on b (v);
+insert b values("k1", 1);
+insert b values("k2", 2);
+insert b values("k3", 3);
+insert b values("k4", 4);
+insert b values("k5", 5);
+insert b values("k6", 6);
+insert b values("k7", 7);
+insert b values("k8", 8);
+insert b values("k9", 9);
+insert b values("k10", 10);
+insert b values("k11", 11);
+insert b values("k12", 12);
+insert b values("k13", 13);
+insert b values("k14", 14);
+insert b values("k15", 15);
+insert b values("k16", 16);
+insert b values("k17", 17);
+insert b values("k18", 18);
+insert b values("k19", 19);
+insert b values("k20", 20);
+insert b values("k21", 21);
+insert b values("k22", 22);
+insert b values("k23", 23);
+insert b values("k24", 24);
+insert b values("k25", 25);
+insert b values("k26", 26);
+insert b values("k27", 27);
+insert b values("k28", 28);
+insert b values("k29", 29);
+insert b values("k30", 30);
+insert b values("k31", 31);
+insert b values("k32", 32);
+insert b values("k33", 33);
+insert b values("k34", 34);
+insert b values("k35", 35);
+insert b values("k36", 36);
+insert b values("k37", 37);
+insert b values("k38", 38);
+insert b values("k39", 39);
+insert b values("k40", 40);
+insert b values("k41", 41);
+insert b values("k42", 42);
+insert b values("k43", 43);
+insert b values("k44", 44);
+insert b values("k45", 45);
+insert b values("k46", 46);
+insert b values("k47", 47);
+insert b values("k48", 48);
+insert b values("k49", 49);
+insert b values("k50", 0);
+insert b values("k51", 1);
+insert b values("k52", 2);
+insert b values("k53", 3);
+insert b values("k54", 4);
+insert b values("k55", 5);
+insert b values("k56", 6);
+insert b values("k57", 7);
+insert b values("k58", 8);
+insert b values("k59", 9);
+insert b values("k60", 10);
+insert b values("k61", 11);
+insert b values("k62", 12);
+insert b values("k63", 13);
+insert b values("k64", 14);
+insert b values("k65", 15);
+insert b values("k66", 16);
+insert b values("k67", 17);
+insert b values("k68", 18);
+insert b values("k69", 19);
+insert b values("k70", 20);
+insert b values("k71", 21);
+insert b values("k72", 22);
+insert b values("k73", 23);
+insert b values("k74", 24);
+insert b values("k75", 25);
+insert b values("k76", 26);
+insert b values("k77", 27);
+insert b values("k78", 28);
+insert b values("k79", 29);
+insert b values("k80", 30);
+insert b values("k81", 31);
+insert b values("k82", 32);
+insert b values("k83", 33);
+insert b values("k84", 34);
+insert b values("k85", 35);
+insert b values("k86", 36);
+insert b values("k87", 37);
+insert b values("k88", 38);
+insert b values("k89", 39);
+insert b values("k90", 40);
+insert b values("k91", 41);
+insert b values("k92", 42);
+insert b values("k93", 43);
+insert b values("k94", 44);
+insert b values("k95", 45);
+insert b values("k96", 46);
+insert b values("k97", 47);
+insert b values("k98", 48);
+insert b values("k99", 49);
+insert b values("k100", 0);
+insert b values("k101", 1);
+insert b values("k102", 2);
+insert b values("k103", 3);
+insert b values("k104", 4);
+insert b values("k105", 5);
+insert b values("k106", 6);
+insert b values("k107", 7);
+insert b values("k108", 8);
+insert b values("k109", 9);
+insert b values("k110", 10);
+insert b values("k111", 11);
+insert b values("k112", 12);
+insert b values("k113", 13);
+insert b values("k114", 14);
+insert b values("k115", 15);
+insert b values("k116", 16);
+insert b values("k117", 17);
+insert b values("k118", 18);
+insert b values("k119", 19);
+insert b values("k120", 20);
+insert b values("k121", 21);
+insert b values("k122", 22);
+insert b values("k123", 23);
+insert b values("k124", 24);
+insert b values("k125", 25);
+insert b values("k126", 26);
+insert b values("k127", 27);
+insert b values("k128", 28);
+insert b values("k129", 29);
+insert b values("k130", 30);
+insert b values("k131", 31);
+insert b values("k132", 32);
+insert b values("k133", 33);
+insert b values("k134", 34);
+insert b values("k135", 35);
+insert b values("k136", 36);
+insert b values("k137", 37);
+insert b values("k138", 38);
+insert b values("k139", 39);
+insert b values("k140", 40);
+insert b values("k141", 41);
+insert b values("k142", 42);
+insert b values("k143", 43);
+insert b values("k144", 44);
+insert b values("k145", 45);
+insert b values("k146", 46);
+insert b values("k147", 47);
+insert b values("k148", 48);
+insert b values("k149", 49);
+insert b values("k150", 0);
+insert b values("k151", 1);
+insert b values("k152", 2);
+insert b values("k153", 3);
+insert b values("k154", 4);
+insert b values("k155", 5);
+insert b values("k156", 6);
+insert b values("k157", 7);
+insert b values("k158", 8);
+insert b values("k159", 9);
+insert b values("k160", 10);
+insert b values("k161", 11);
+insert b values("k162", 12);
+insert b values("k163", 13);
+insert b values("k164", 14);
+insert b values("k165", 15);
+insert b values("k166", 16);
+insert b values("k167", 17);
+insert b values("k168", 18);
+insert b values("k169", 19);
+insert b values("k170", 20);
+insert b values("k171", 21);
+insert b values("k172", 22);
+insert b values("k173", 23);
+insert b values("k174", 24);
+insert b values("k175", 25);
+insert b values("k176", 26);
+insert b values("k177", 27);
+insert b values("k178", 28);
+insert b values("k179", 29);
+insert b values("k180", 30);
+insert b values("k181", 31);
+insert b values("k182", 32);
+insert b values("k183", 33);
+insert b values("k184", 34);
+insert b values("k185", 35);
+insert b values("k186", 36);
+insert b values("k187", 37);
+insert b values("k188", 38);
+insert b values("k189", 39);
+insert b values("k190", 40);
+insert b values("k191", 41);
+insert b values("k192", 42);
+insert b values("k193", 43);
+insert b values("k194", 44);
+insert b values("k195", 45);
+insert b values("k196", 46);
+insert b values("k197", 47);
+insert b values("k198", 48);
+insert b values("k199", 49);
+insert b values("k200", 0);
+insert b values("k201", 1);
+insert b values("k202", 2);
+insert b values("k203", 3);
+insert b values("k204", 4);
+insert b values("k205", 5);
+insert b values("k206", 6);
+insert b values("k207", 7);
+insert b values("k208", 8);
+insert b values("k209", 9);
+insert b values("k210", 10);
+insert b values("k211", 11);
+insert b values("k212", 12);
+insert b values("k213", 13);
+insert b values("k214", 14);
+insert b values("k215", 15);
+insert b values("k216", 16);
+insert b values("k217", 17);
+insert b values("k218", 18);
+insert b values("k219", 19);
+insert b values("k220", 20);
+insert b values("k221", 21);
+insert b values("k222", 22);
+insert b values("k223", 23);
+insert b values("k224", 24);
+insert b values("k225", 25);
+insert b values("k226", 26);
+insert b values("k227", 27);
+insert b values("k228", 28);
+insert b values("k229", 29);
+insert b values("k230", 30);
+insert b values("k231", 31);
+insert b values("k232", 32);
+insert b values("k233", 33);
+insert b values("k234", 34);
+insert b values("k235", 35);
+insert b values("k236", 36);
+insert b values("k237", 37);
+insert b values("k238", 38);
+insert b values("k239", 39);
+insert b values("k240", 40);
+insert b values("k241", 41);
+insert b values("k242", 42);
+insert b values("k243", 43);
+insert b values("k244", 44);
+insert b values("k245", 45);
+insert b values("k246", 46);
+insert b values("k247", 47);
+insert b values("k248", 48);
+insert b values("k249", 49);
+insert b values("k250", 0);
+insert b values("k251", 1);
+insert b values("k252", 2);
+insert b values("k253", 3);
+insert b values("k254", 4);
+insert b values("k255", 5);
+insert b values("k256", 6);
+insert b values("k257", 7);
+insert b values("k258", 8);
+insert b values("k259", 9);
+insert b values("k260", 10);
+insert b values("k261", 11);
+insert b values("k262", 12);
+insert b values("k263", 13);
+insert b values("k264", 14);
+insert b values("k265", 15);
+insert b values("k266", 16);
+insert b values("k267", 17);
+insert b values("k268", 18);
+insert b values("k269", 19);
+insert b values("k270", 20);
+insert b values("k271", 21);
+insert b values("k272", 22);
+insert b values("k273", 23);
+insert b values("k274", 24);
+insert b values("k275", 25);
+insert b values("k276", 26);
+insert b values("k277", 27);
+insert b values("k278", 28);
+insert b values("k279", 29);
+insert b values("k280", 30);
+insert b values("k281", 31);
+insert b values("k282", 32);
+insert b values("k283", 33);
+insert b values("k284", 34);
+insert b values("k285", 35);
+insert b values("k286", 36);
+insert b values("k287", 37);
+insert b values("k288", 38);
+insert b values("k289", 39);
+insert b values("k290", 40);
+insert b values("k291", 41);
+insert b values("k292", 42);
+insert b values("k293", 43);
+insert b values("k294", 44);
+insert b values("k295", 45);
+insert b values("k296", 46);
+insert b values("k297", 47);
+insert b values("k298", 48);
+insert b values("k299", 49);
+insert b values("k300", 0);
+select * from b where k = "k1";
+select * from b where k = "k300";
+select * from b where k = "k301";
+select * from b where k = "nope";
+select k from b where v = 49, k >= "k98";
+select k from b where v = 50;
+delete b where k = "k7";
+select * from b where k = "k7";
+insert b values("k7", 77);
+create table x(id int primary);
+create table y(id int primary);
+create table z(id int primary);
+insert x values(1);
+insert y values(1);
+insert z values(1);
+select * from b where k = "k7";
+select k from b where v = 77;
+select * from b where k = "k999";
+exit;
@@ -0,0 +1,17 @@
+create database t;
+use t;
+show pool;
+set pool 0;
+set pool 1;
+create table p(id int primary, name string, v int);
+insert p values(1, "a", 10);
+insert p values(2, "b", 20);
+insert p values(3, "c", 30);
+update p set v = 0 where id >= 2;
+delete p where id = 1;
+select * from p;
+show pool;
+set pool 64;
+select * from p where id = 3;
+show pool;
+exit;
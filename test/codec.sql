@@ -0,0 +1,13 @@
+create database t;
+use t;
+create table z(id int primary, state string, tag string, near int, wide int) with (storage = column);
+load z from "../../test/codec.txt";
+select * from z where id <= 4;
+select id, state, wide from z where id >= 148, id <= 152;
+select id, wide from z where wide > 1000;
+select id, near from z where near = 500199;
+select id from z where tag = "blue", id <= 20;
+update z set tag = "white" where id = 10;
+update z set near = -7 where id = 11;
+select * from z where id >= 9, id <= 12;
+exit;
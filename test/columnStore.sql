@@ -0,0 +1,132 @@
+create database t;
+use t;
+create table c(id int primary, city string, qty int, note string) with (storage = column);
+insert c values(1, "paris", 1001, "n1");
+insert c values(2, "paris", 1002, "n2");
+insert c values(3, "paris", 1003, "n3");
+insert c values(4, "paris", 1004, "n4");
+insert c values(5, "paris", 1005, "n5");
+insert c values(6, "paris", 1006, "n6");
+insert c values(7, "paris", 1000, "n7");
+insert c values(8, "paris", 1001, "n8");
+insert c values(9, "paris", 1002, "n9");
+insert c values(10, "paris", 1003, "n10");
+insert c values(11, "paris", 1004, "n11");
+insert c values(12, "paris", 1005, "n12");
+insert c values(13, "paris", 1006, "n13");
+insert c values(14, "paris", 1000, "n14");
+insert c values(15, "paris", 1001, "n15");
+insert c values(16, "paris", 1002, "n16");
+insert c values(17, "paris", 1003, "n17");
+insert c values(18, "paris", 1004, "n18");
+insert c values(19, "paris", 1005, "n19");
+insert c values(20, "paris", 1006, "n20");
+insert c values(21, "paris", 1000, "n21");
+insert c values(22, "paris", 1001, "n22");
+insert c values(23, "paris", 1002, "n23");
+insert c values(24, "paris", 1003, "n24");
+insert c values(25, "paris", 1004, "n25");
+insert c values(26, "paris", 1005, "n26");
+insert c values(27, "paris", 1006, "n27");
+insert c values(28, "paris", 1000, "n28");
+insert c values(29, "paris", 1001, "n29");
+insert c values(30, "paris", 1002, "n30");
+insert c values(31, "paris", 1003, "n31");
+insert c values(32, "paris", 1004, "n32");
+insert c values(33, "paris", 1005, "n33");
+insert c values(34, "paris", 1006, "n34");
+insert c values(35, "paris", 1000, "n35");
+insert c values(36, "paris", 1001, "n36");
+insert c values(37, "paris", 1002, "n37");
+insert c values(38, "paris", 1003, "n38");
+insert c values(39, "paris", 1004, "n39");
+insert c values(40, "paris", 1005, "n40");
+insert c values(41, "rome", 1006, "n41");
+insert c values(42, "rome", 1000, "n42");
+insert c values(43, "rome", 1001, "n43");
+insert c values(44, "rome", 1002, "n44");
+insert c values(45, "rome", 1003, "n45");
+insert c values(46, "rome", 1004, "n46");
+insert c values(47, "rome", 1005, "n47");
+insert c values(48, "rome", 1006, "n48");
+insert c values(49, "rome", 1000, "n49");
+insert c values(50, "rome", 1001, "n50");
+insert c values(51, "rome", 1002, "n51");
+insert c values(52, "rome", 1003, "n52");
+insert c values(53, "rome", 1004, "n53");
+insert c values(54, "rome", 1005, "n54");
+insert c values(55, "rome", 1006, "n55");
+insert c values(56, "rome", 1000, "n56");
+insert c values(57, "rome", 1001, "n57");
+insert c values(58, "rome", 1002, "n58");
+insert c values(59, "rome", 1003, "n59");
+insert c values(60, "rome", 1004, "n60");
+insert c values(61, "rome", 1005, "n61");
+insert c values(62, "rome", 1006, "n62");
+insert c values(63, "rome", 1000, "n63");
+insert c values(64, "rome", 1001, "n64");
+insert c values(65, "rome", 1002, "n65");
+insert c values(66, "rome", 1003, "n66");
+insert c values(67, "rome", 1004, "n67");
+insert c values(68, "rome", 1005, "n68");
+insert c values(69, "rome", 1006, "n69");
+insert c values(70, "rome", 1000, "n70");
+insert c values(71, "rome", 1001, "n71");
+insert c values(72, "rome", 1002, "n72");
+insert c values(73, "rome", 1003, "n73");
+insert c values(74, "rome", 1004, "n74");
+insert c values(75, "rome", 1005, "n75");
+insert c values(76, "rome", 1006, "n76");
+insert c values(77, "rome", 1000, "n77");
+insert c values(78, "rome", 1001, "n78");
+insert c values(79, "rome", 1002, "n79");
+insert c values(80, "rome", 1003, "n80");
+insert c values(81, "oslo", 1004, "n81");
+insert c values(82, "oslo", 1005, "n82");
+insert c values(83, "oslo", 1006, "n83");
+insert c values(84, "oslo", 1000, "n84");
+insert c values(85, "oslo", 1001, "n85");
+insert c values(86, "oslo", 1002, "n86");
+insert c values(87, "oslo", 1003, "n87");
+insert c values(88, "oslo", 1004, "n88");
+insert c values(89, "oslo", 1005, "n89");
+insert c values(90, "oslo", 1006, "n90");
+insert c values(91, "oslo", 1000, "n91");
+insert c values(92, "oslo", 1001, "n92");
+insert c values(93, "oslo", 1002, "n93");
+insert c values(94, "oslo", 1003, "n94");
+insert c values(95, "oslo", 1004, "n95");
+insert c values(96, "oslo", 1005, "n96");
+insert c values(97, "oslo", 1006, "n97");
+insert c values(98, "oslo", 1000, "n98");
+insert c values(99, "oslo", 1001, "n99");
+insert c values(100, "oslo", 1002, "n100");
+insert c values(101, "oslo", 1003, "n101");
+insert c values(102, "oslo", 1004, "n102");
+insert c values(103, "oslo", 1005, "n103");
+insert c values(104, "oslo", 1006, "n104");
+insert c values(105, "oslo", 1000, "n105");
+insert c values(106, "oslo", 1001, "n106");
+insert c values(107, "oslo", 1002, "n107");
+insert c values(108, "oslo", 1003, "n108");
+insert c values(109, "oslo", 1004, "n109");
+insert c values(110, "oslo", 1005, "n110");
+insert c values(111, "oslo", 1006, "n111");
+insert c values(112, "oslo", 1000, "n112");
+insert c values(113, "oslo", 1001, "n113");
+insert c values(114, "oslo", 1002, "n114");
+insert c values(115, "oslo", 1003, "n115");
+insert c values(116, "oslo", 1004, "n116");
+insert c values(117, "oslo", 1005, "n117");
+insert c values(118, "oslo", 1006, "n118");
+insert c values(119, "oslo", 1000, "n119");
+insert c values(120, "oslo", 1001, "n120");
+select id, qty from c where id <= 3;
+select id from c where city = "oslo", id <= 82;
+select id, note from c where qty = 1006, id >= 100;
+update c set city = "lima" where id = 41;
+select id, city from c where id >= 40, id <= 42;
+update c set qty = -5 where id >= 119;
+delete c where id > 3, id < 117;
+select * from c;
+exit;
@@ -0,0 +1,18 @@
+create database t;
+use t;
+create table h(id int primary, g string, m int) using hash;
+load h from "../../test/hash.txt";
+create index hg on h (g) using hash;
+create index hm on h (m) using hash;
+select * from h where id = 1150;
+select id from h where g = "same", id >= 1098;
+select id from h where g = "g3";
+select id from h where m = 12, id > 1150;
+select id from h where g = "none";
+insert h values(5000, "same", 12);
+delete h where id <= 1097;
+select id from h where g = "same";
+update h set g = "moved" where id = 1099;
+select id, g from h where g = "moved";
+select id from h where m = 12, id > 1150;
+exit;
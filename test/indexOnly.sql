@@ -0,0 +1,24 @@
+create database t;
+use t;
+create table f(id int primary, name string);
+insert f values(1, "a");
+insert f values(2);
+insert f values(3, "c", 5);
+insert f values(4, "d");
+select * from f;
+select id from f;
+select id from f where id >= 2;
+select id from f where id = 2;
+create table p(tenant int primary, ts int primary, tel string);
+create index pt on p (tel);
+insert p values(1, 100, "tel1");
+insert p values(1, 200, "tel2");
+insert p values(2, 100, "tel3");
+insert p values(2, 300);
+select tenant, ts from p;
+select ts from p where tenant = 1, ts >= 150;
+select tel from p where tel >= "tel2";
+delete p where tel = "tel2";
+select tel from p;
+select tenant, ts from p;
+exit;
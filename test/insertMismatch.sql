@@ -0,0 +1,20 @@
+create database t;
+use t;
+create table f(id int primary, name string);
+insert f values(1, "a");
+insert f values(2);
+insert f values(2, "b");
+insert f values(3, "c", 5);
+insert f values(1);
+select * from f;
+select id from f;
+create table g(k string primary, v int, w string);
+create index gw on g (w);
+insert g values("a", 1, "x");
+insert g values("b", 2);
+insert g values("b", 2, "y");
+insert g values("a", 3);
+select * from g;
+select * from g where w = "x";
+select * from g where w = "y";
+exit;
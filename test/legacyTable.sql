@@ -0,0 +1,7 @@
+use legacy;
+select * from p;
+insert p values(3, "c");
+create table p(id int primary, name string);
+insert p values(3, "c");
+select * from p;
+exit;
@@ -0,0 +1,17 @@
+create database t;
+use t;
+create table l(id int primary, name string, v int);
+insert l values(2, "old", 0);
+insert l values(9, "keep", 90);
+create index lv on l (v);
+create index ln on l (name) using hash;
+load l from "../../test/load.txt";
+select * from l;
+select id, name from l where v = 11;
+select id from l where v = 10;
+select id from l where v = 0;
+select id from l where v = 50;
+select id, v from l where name = "b";
+select id from l where name = "old";
+select id, name from l where v >= 60;
+exit;
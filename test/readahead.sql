@@ -0,0 +1,13 @@
+create database t;
+use t;
+create table h(id int primary, g string, m int);
+load h from "../../test/hash.txt";
+create index hm on h (m);
+set readahead 0;
+select id from h where m = 12, id > 1000;
+set readahead 4;
+select id from h where m = 12, id > 1000;
+select id, g from h where id >= 1195;
+show pool;
+set readahead 32;
+exit;
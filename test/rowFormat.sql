@@ -0,0 +1,13 @@
+create database t;
+use t;
+create table r(a int, b string, c int primary, d string, e int);
+insert r values(-5, "first", 1, "x", 2147483647);
+insert r values(0, "", 2, "second row", -2147483648);
+insert r values(7, "a b c", 3, "z", 0);
+select * from r;
+select e, c, b from r where a >= 0;
+select d from r where e < 0;
+update r set b = "changed to a longer value" where c = 2;
+update r set e = 42 where d = "z";
+select * from r;
+exit;
@@ -0,0 +1,10 @@
+use stale;
+select * from p;
+select name from p where id = 2;
+select id from p where name = "c";
+insert p values(4, "d");
+select id, name from p where id >= 3;
+select id from p where name = "d";
+select * from s;
+select v from s where name = "y";
+exit;
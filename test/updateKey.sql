@@ -0,0 +1,33 @@
+create database t;
+use t;
+create table s(name string primary, age int);
+insert s values("a", 1);
+insert s values("b", 2);
+update s set name = "zz" where name = "a";
+select * from s;
+select name from s;
+select * from s where name = "a";
+update s set name = "b" where name = "zz";
+select name from s;
+create table n(id int primary, v int);
+insert n values(1, 10);
+insert n values(2, 20);
+update n set id = 9 where id = 1;
+select id from n;
+select * from n where id = 9;
+update n set id = 5 where v > 0;
+select id from n;
+create table c(a string primary, b string primary, x int);
+create index cb on c (b);
+insert c values("p", "q", 1);
+insert c values("p", "r", 2);
+update c set b = "z" where x = 1;
+select a, b from c;
+select * from c where b = "z";
+update c set b = "z" where a = "p";
+select a, b from c;
+drop table s;
+drop table n;
+drop table c;
+drop database t;
+exit;